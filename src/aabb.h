@@ -0,0 +1,53 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <limits>
+#include "ray.h"
+#include "raybox.h"
+
+struct AABB {
+  glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+  void expand(const glm::vec3& p) {
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+  }
+
+  void expand(const AABB& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  glm::vec3 centroid() const {
+    return (min + max) * 0.5f;
+  }
+
+  float surfaceArea() const {
+    glm::vec3 d = max - min;
+    if (d.x < 0 || d.y < 0 || d.z < 0) {
+      return 0.0f;
+    }
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+  // Mismo slab test que rayBox; devuelve las distancias de entrada (negativa si
+  // el origen está adentro) y salida, o false si la caja no cruza el rayo a
+  // partir de tMin. El llamador compara con tMax (ver clipToRay).
+  bool intersect(const Ray& ray, float& tNear, float& tFar) const {
+    glm::vec3 nearPlanes(ray.sign[0] ? max.x : min.x, ray.sign[1] ? max.y : min.y, ray.sign[2] ? max.z : min.z);
+    glm::vec3 farPlanes(ray.sign[0] ? min.x : max.x, ray.sign[1] ? min.y : max.y, ray.sign[2] ? min.z : max.z);
+
+    glm::vec3 tmin = (nearPlanes - ray.origin) * ray.invDir;
+    glm::vec3 tmax = (farPlanes - ray.origin) * ray.invDir;
+
+    tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
+    tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+
+    return !(tNear > tFar * SLAB_TOLERANCE || tFar < ray.tMin);
+  }
+
+  bool intersect(const Ray& ray, float& tNear) const {
+    float tFar;
+    return intersect(ray, tNear, tFar);
+  }
+};
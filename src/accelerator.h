@@ -0,0 +1,300 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include "boxsoa.h"
+#include "counters.h"
+#include "ray.h"
+#include "raypacket.h"
+#include "scene.h"
+#include "threadpool.h"
+
+// Estructura de búsqueda de rayos sobre los primitivos de la escena.
+class Accelerator {
+public:
+  struct Stats {
+    double buildMs = 0.0;
+    int nodeCount = 0;   // nodos del BVH, celdas de la grilla, objetos en fuerza bruta
+    size_t bytes = 0;    // memoria de la estructura, sin contar la tabla de la escena
+    uint64_t rays = 0;
+    uint64_t steps = 0;  // nodos/celdas/objetos visitados
+    // Rayos de impacto más cercano por modo y el tiempo pasado en cada uno
+    uint64_t singleRays = 0;
+    uint64_t singleNs = 0;
+    uint64_t packetRays = 0;
+    uint64_t packetNs = 0;
+  };
+
+  virtual ~Accelerator() = default;
+
+  virtual const char* name() const = 0;
+
+  void build(const Scene& sceneToBuild, ThreadPool& pool) {
+    auto start = std::chrono::steady_clock::now();
+    scene = &sceneToBuild;
+    buildStructure(pool);
+    finishBuild(start);
+  }
+
+  // Impacto más cercano dentro de [ray.tMin, ray.tMax] (distancia, primitivo y
+  // cara), ignorando `ignore`. Ante empates gana el id menor, igual que el
+  // recorrido lineal. Los atributos de sombreado se piden después a
+  // Scene::surface, solo para este impacto.
+  Hit closestHit(Ray ray, int ignore) const {
+    auto start = std::chrono::steady_clock::now();
+    Hit hit;
+    hit.primitive = findClosest(ray, ignore);
+    closestObject(ray, ignore, hit.primitive);
+    if (hit.primitive >= 0) {
+      hit.dist = ray.tMax;
+      hit.face = scene->face(hit.primitive, ray);
+    }
+    addTime(SINGLE_RAYS, SINGLE_NS, 1, start);
+    return hit;
+  }
+
+  // Impacto más cercano (distancia, id y cara) para cada carril del paquete.
+  // Si la estructura no tiene recorrido por paquetes se traza rayo por rayo.
+  void closestHitPacket(const RayPacket& packet, PacketHit& hit) const {
+    if (!supportsPackets()) {
+      for (int lane = 0; lane < packet.count; lane++) {
+        hit.set(lane, closestHit(packet.ray(lane), -1));
+      }
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    findClosestPacket(packet, hit);
+    for (int lane = 0; lane < packet.count; lane++) {
+      Ray ray = packet.ray(lane);
+      ray.tMax = hit.dist[lane];
+      closestObject(ray, -1, hit.ids[lane]);
+      hit.dist[lane] = ray.tMax;
+      hit.faces[lane] = (hit.ids[lane] >= 0) ? scene->face(hit.ids[lane], ray) : -1;
+    }
+    addTime(PACKET_RAYS, PACKET_NS, packet.count, start);
+  }
+
+  // ¿Hay algún primitivo (salvo `ignore`) a distancia en (tMin, tMax)? hitDist
+  // queda en la distancia del oclusor más cercano, que no depende del recorrido
+  // de la estructura ni del hilo: la sombra sale igual con cualquier acelerador
+  // y cantidad de hilos. El último oclusor de este hilo se prueba primero
+  // porque los píxeles vecinos suelen compartirlo; su distancia solo acota la
+  // búsqueda, que sigue por si hay uno más cercano.
+  bool occluded(Ray ray, int ignore, float& hitDist) const {
+    thread_local LastOccluder last;
+    int occluder = -1;
+    float lastDist;
+    if (last.buildId == buildId && last.id >= 0 && last.id != ignore && scene->occluded(last.id, ray, lastDist)) {
+      ray.tMax = lastDist;
+      occluder = last.id;
+    }
+    int block = findOccluder(ray, ignore);
+    if (block >= 0) {
+      occluder = block;
+    }
+    for (int id = scene->blockCount(); id < scene->size(); id++) {
+      float objectDist;
+      SR1_COUNT(INTERSECTION_TESTS, 1);
+      if (id != ignore && scene->occluded(id, ray, objectDist)) {
+        ray.tMax = objectDist;
+        occluder = id;
+      }
+    }
+    if (occluder < 0) {
+      return false;
+    }
+    last = LastOccluder{occluder, buildId};
+    hitDist = ray.tMax;
+    return true;
+  }
+
+  // Tiempo de construcción y nodos, sin tocar los contadores de rayos
+  const Stats& buildInfo() const {
+    return stats;
+  }
+
+  // Acumula los contadores de todos los hilos desde la última llamada
+  Stats collectStats() const {
+    uint64_t totals[COUNTER_COUNT] = {};
+    {
+      std::lock_guard<std::mutex> lock(countersMutex);
+      for (auto& counter : counters) {
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+          uint64_t value = counter.values[i].load(std::memory_order_relaxed);
+          totals[i] += value - counter.reported[i];
+          counter.reported[i] = value;
+        }
+      }
+    }
+    Stats result = stats;
+    result.rays = totals[RAYS];
+    result.steps = totals[STEPS];
+    result.singleRays = totals[SINGLE_RAYS];
+    result.singleNs = totals[SINGLE_NS];
+    result.packetRays = totals[PACKET_RAYS];
+    result.packetNs = totals[PACKET_NS];
+    return result;
+  }
+
+protected:
+  // Las estructuras indexan solo los bloques de la escena; los objetos que no
+  // son bloques se prueban aparte, de a uno, con la interfaz virtual.
+  virtual void buildStructure(ThreadPool& pool) = 0;
+
+  // Bloque más cercano dentro de [tMin, tMax], o -1. Cada impacto achica
+  // ray.tMax, que al final queda en la distancia del ganador.
+  virtual int findClosest(Ray& ray, int ignore) const = 0;
+
+  virtual bool supportsPackets() const {
+    return false;
+  }
+
+  virtual void findClosestPacket(const RayPacket&, PacketHit&) const {}
+
+  // Bloque más cercano que ocluye el rayo en (tMin, tMax), o -1. Como en
+  // findClosest, cada oclusor achica ray.tMax, que queda en su distancia.
+  virtual int findOccluder(Ray& ray, int ignore) const = 0;
+
+  // Bytes reservados por la estructura; la fuerza bruta recorre la tabla de la escena
+  virtual size_t memoryBytes() const {
+    return 0;
+  }
+
+  // Cierra una construcción (o una carga ya construida): guarda lo que tardó e
+  // invalida los cachés por hilo de la anterior
+  void finishBuild(std::chrono::steady_clock::time_point start) {
+    stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.bytes = memoryBytes();
+    buildId = nextBuildId.fetch_add(1);
+  }
+
+  static void countRay(uint64_t steps) {
+    Counter& counter = localCounter();
+    counter.add(RAYS, 1);
+    counter.add(STEPS, steps);
+    SR1_COUNT(INTERSECTION_TESTS, steps);
+  }
+
+  const Scene* scene = nullptr;
+  Stats stats;
+
+private:
+  struct LastOccluder {
+    int id = -1;
+    uint64_t buildId = 0;
+  };
+
+  // Los objetos que no son bloques tienen ids mayores, así que solo ganan con < estricto
+  void closestObject(Ray& ray, int ignore, int& hitId) const {
+    for (int id = scene->blockCount(); id < scene->size(); id++) {
+      float objectDist;
+      SR1_COUNT(INTERSECTION_TESTS, 1);
+      if (id != ignore && scene->hitDistance(id, ray, objectDist) && objectDist < ray.tMax) {
+        ray.tMax = objectDist;
+        hitId = id;
+      }
+    }
+  }
+
+  // Identifica cada construcción para invalidar los cachés por hilo
+  uint64_t buildId = 0;
+  inline static std::atomic<uint64_t> nextBuildId{1};
+
+  enum CounterId { RAYS, STEPS, SINGLE_RAYS, SINGLE_NS, PACKET_RAYS, PACKET_NS, COUNTER_COUNT };
+
+  // Un contador por hilo en su propia línea de caché; solo su hilo escribe.
+  struct alignas(64) Counter {
+    std::atomic<uint64_t> values[COUNTER_COUNT] = {};
+    uint64_t reported[COUNTER_COUNT] = {};
+
+    void add(int id, uint64_t amount) {
+      values[id].store(values[id].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+  };
+
+  static Counter& localCounter() {
+    thread_local Counter* counter = nullptr;
+    if (!counter) {
+      std::lock_guard<std::mutex> lock(countersMutex);
+      counter = &counters.emplace_back();
+    }
+    return *counter;
+  }
+
+  static void addTime(int raysId, int nanosId, uint64_t rays, std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    Counter& counter = localCounter();
+    counter.add(raysId, rays);
+    counter.add(nanosId, static_cast<uint64_t>(elapsed.count()));
+  }
+
+  inline static std::mutex countersMutex;
+  inline static std::deque<Counter> counters;
+};
+
+// El recorrido lineal original: prueba cada bloque en orden, de a PACKET_SIZE
+// cajas por instrucción.
+class BruteForce : public Accelerator {
+public:
+  const char* name() const override {
+    return "Fuerza bruta";
+  }
+
+protected:
+  int findClosest(Ray& ray, int ignore) const override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int hitIndex = -1;
+    blocks.closest(ray, 0, blocks.size(), ignore, hitIndex);
+    countRay(blocks.size());
+    return hitIndex;
+  }
+
+  bool supportsPackets() const override {
+    return true;
+  }
+
+  void findClosestPacket(const RayPacket& packet, PacketHit& hit) const override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    PacketLanes lanes(packet);
+    for (int lane = 0; lane < PACKET_SIZE; lane++) {
+      hit.dist[lane] = packet.tMax[lane];
+      hit.ids[lane] = -1;
+    }
+
+    // Recorriendo en orden, con < estricto gana el primero en empates; un
+    // impacto justo en tMax vale mientras no haya otro
+    for (int i = 0; i < blocks.size(); i++) {
+      alignas(32) float dist[PACKET_SIZE];
+      Lanes tNear, laneDist;
+      int mask = lanes.intersect(blocks.box(i), tNear, laneDist) & packet.activeMask();
+      lanesStore(dist, laneDist);
+      for (int lane = 0; lane < packet.count; lane++) {
+        if ((mask & (1 << lane)) &&
+            (dist[lane] < hit.dist[lane] || (dist[lane] == hit.dist[lane] && hit.ids[lane] < 0))) {
+          hit.dist[lane] = dist[lane];
+          hit.ids[lane] = i;
+        }
+      }
+    }
+
+    for (int lane = 0; lane < packet.count; lane++) {
+      countRay(blocks.size());
+    }
+  }
+
+  void buildStructure(ThreadPool&) override {
+    stats.nodeCount = scene->blockCount();
+  }
+
+  int findOccluder(Ray& ray, int ignore) const override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int occluder = -1;
+    blocks.occluder(ray, 0, blocks.size(), ignore, occluder);
+    countRay(blocks.size());
+    return occluder;
+  }
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include "framebuffer.h"
+#include "globals.h"
+#include "radiance.h"
+
+// Antialiasing adaptativo: con el rayo central de cada píxel ya trazado, se
+// mide el contraste de cada cuadrado de 2x2 píxeles (y si cambia el primitivo
+// o la cara) y solo los cuadrados más contrastados reciben muestras extra,
+// hasta gastar el presupuesto de rayos del tile.
+class AdaptiveSampler {
+public:
+  // Muestras extra por píxel en cada ronda y rondas como máximo: hasta 1 + 8 muestras
+  static constexpr int SAMPLES_PER_ROUND = 4;
+  static constexpr int MAX_ROUNDS = 2;
+  // Diferencia de luminancia comprimida (x / (1 + x)) dentro del cuadrado a
+  // partir de la cual vale la pena refinarlo
+  static constexpr float CONTRAST_THRESHOLD = 0.06f;
+
+  // Primer rayo de cada píxel del tile: qué primitivo y qué cara vio
+  struct Tile {
+    int x0, y0, x1, y1;
+    int ids[TILE_SIZE][TILE_SIZE];
+    int faces[TILE_SIZE][TILE_SIZE];
+
+    Tile(int x0, int y0, int x1, int y1) : x0(x0), y0(y0), x1(x1), y1(y1) {}
+
+    void record(int x, int y, int primitive, int face) {
+      ids[y - y0][x - x0] = primitive;
+      faces[y - y0][x - x0] = face;
+    }
+  };
+
+  // Rayos por píxel en promedio, contando el central; 1 o menos lo apaga
+  void setBudget(float raysPerPixel) {
+    budget = std::max(1.0f, raysPerPixel);
+  }
+
+  bool isEnabled() const {
+    return budget > 1.0f;
+  }
+
+  // Agrega muestras a los cuadrados de `tile` que lo necesitan y deja en
+  // `frame` el promedio. trace(x, y, offset) devuelve la radiancia del rayo
+  // desplazado `offset` desde el centro del píxel.
+  template <typename Trace>
+  void refine(HdrFramebuffer& frame, const Tile& tile, Trace trace) {
+    const int width = tile.x1 - tile.x0;
+    const int height = tile.y1 - tile.y0;
+    int extraRays = static_cast<int>((budget - 1.0f) * width * height);
+    uint64_t rays = static_cast<uint64_t>(width) * height;
+
+    QuadScore quads[(TILE_SIZE / 2) * (TILE_SIZE / 2)];
+    int quadCount = 0;
+    for (int qy = 0; qy < height; qy += 2) {
+      for (int qx = 0; qx < width; qx += 2) {
+        float score = contrast(frame, tile, qx, qy);
+        if (score >= CONTRAST_THRESHOLD) {
+          quads[quadCount++] = QuadScore{score, qx, qy};
+        }
+      }
+    }
+    std::sort(quads, quads + quadCount, [](const QuadScore& a, const QuadScore& b) { return a.score > b.score; });
+
+    // Los cuadrados más contrastados primero; la segunda ronda solo si sobra
+    // presupuesto después de darle una a todos
+    int rounds[(TILE_SIZE / 2) * (TILE_SIZE / 2)] = {};
+    bool exhausted = false;
+    for (int round = 0; round < MAX_ROUNDS && !exhausted; round++) {
+      for (int i = 0; i < quadCount; i++) {
+        int cost = SAMPLES_PER_ROUND * quadPixels(tile, quads[i].x, quads[i].y);
+        if (cost > extraRays) {
+          exhausted = true;
+          break;
+        }
+        extraRays -= cost;
+        rounds[i]++;
+      }
+    }
+
+    for (int i = 0; i < quadCount && rounds[i] > 0; i++) {
+      int samples = rounds[i] * SAMPLES_PER_ROUND;
+      for (int y = tile.y0 + quads[i].y; y < std::min(tile.y0 + quads[i].y + 2, tile.y1); y++) {
+        for (int x = tile.x0 + quads[i].x; x < std::min(tile.x0 + quads[i].x + 2, tile.x1); x++) {
+          Radiance sum = frame.at(x, y);
+          for (int sample = 0; sample < samples; sample++) {
+            sum += trace(x, y, OFFSETS[sample]);
+          }
+          frame.at(x, y) = sum / static_cast<float>(samples + 1);
+          rays += samples;
+        }
+      }
+    }
+
+    tracedRays.fetch_add(rays, std::memory_order_relaxed);
+    tracedPixels.fetch_add(static_cast<uint64_t>(width) * height, std::memory_order_relaxed);
+  }
+
+  // Muestras por píxel en promedio desde la última llamada (0 si no se refinó nada)
+  double collectAverageSamples() {
+    uint64_t pixels = tracedPixels.exchange(0, std::memory_order_relaxed);
+    uint64_t rays = tracedRays.exchange(0, std::memory_order_relaxed);
+    return pixels > 0 ? static_cast<double>(rays) / pixels : 0.0;
+  }
+
+private:
+  struct QuadScore {
+    float score;
+    int x, y; // esquina dentro del tile
+  };
+
+  // Desplazamientos dentro del píxel: dos grillas rotadas de 4 (RGSS), la
+  // segunda girada 45 grados respecto a la primera
+  inline static const glm::vec2 OFFSETS[SAMPLES_PER_ROUND * MAX_ROUNDS] = {
+    {0.125f, -0.375f}, {0.375f, 0.125f}, {-0.125f, 0.375f}, {-0.375f, -0.125f},
+    {-0.25f, -0.25f}, {0.25f, -0.25f}, {0.25f, 0.25f}, {-0.25f, 0.25f},
+  };
+
+  static float luminance(const Radiance& color) {
+    float value = 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b;
+    value = std::max(value, 0.0f);
+    return value / (1.0f + value);
+  }
+
+  static int quadPixels(const Tile& tile, int qx, int qy) {
+    return (std::min(2, tile.x1 - tile.x0 - qx)) * (std::min(2, tile.y1 - tile.y0 - qy));
+  }
+
+  // Rango de luminancia del cuadrado; un borde de objeto o de cara cuenta
+  // siempre como más contrastado que cualquier textura
+  static float contrast(const HdrFramebuffer& frame, const Tile& tile, int qx, int qy) {
+    float minimum = 1.0f;
+    float maximum = 0.0f;
+    bool edge = false;
+    int id = tile.ids[qy][qx];
+    int face = tile.faces[qy][qx];
+    for (int y = qy; y < std::min(qy + 2, tile.y1 - tile.y0); y++) {
+      for (int x = qx; x < std::min(qx + 2, tile.x1 - tile.x0); x++) {
+        float value = luminance(frame.at(tile.x0 + x, tile.y0 + y));
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        edge = edge || tile.ids[y][x] != id || tile.faces[y][x] != face;
+      }
+    }
+    return maximum - minimum + (edge ? 1.0f : 0.0f);
+  }
+
+  float budget = 2.0f;
+  std::atomic<uint64_t> tracedRays{0};
+  std::atomic<uint64_t> tracedPixels{0};
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "binaryfile.h"
+#include "color.h"
+#include "imageloader.h"
+#include "mappedfile.h"
+#include "radiance.h"
+#include "skybox.h"
+
+// Paquete de texturas ya decodificadas (.sr1pack), lo escribe sr1_pack. Un
+// directorio al principio y después los texels de cada entrada tal como los
+// usa el muestreo, alineados a 64 bytes:
+//
+//   TEXTURE          Color por texel, fila 0 abajo (como Texture)
+//   SKY_CUBE         el mapa cúbico horneado del cielo, Color
+//   SKY_PREFILTERED  su versión reducida y prefiltrada, Radiance
+//
+// load() proyecta el archivo y registra las entradas apuntando dentro de la
+// proyección, sin copiar ni convertir: solo se leen del disco las páginas que
+// el render toca.
+class AssetPack {
+public:
+    struct Summary {
+        int textures = 0;
+        bool sky = false;
+        size_t bytes = 0;
+    };
+
+    // Escribe las texturas `keys` ya registradas en ImageLoader y, con
+    // `includeSky`, los mapas del cielo, horneando las caras que falten
+    static void write(const std::string& path, const std::vector<std::string>& keys, bool includeSky) {
+        std::vector<Entry> entries;
+        for (const std::string& key : keys) {
+            const Texture& texture = ImageLoader::texture(ImageLoader::getHandle(key));
+            entries.push_back(Entry{TEXTURE, key, static_cast<std::uint32_t>(texture.width), static_cast<std::uint32_t>(texture.height),
+                                    texture.size.x, texture.size.y, texture.data(), sizeof(Color)});
+        }
+        if (includeSky) {
+            Skybox::bakeAll();
+            const CubeMap<Color>& cube = Skybox::bakedCube();
+            const CubeMap<Radiance>& prefiltered = Skybox::bakedPrefiltered();
+            entries.push_back(Entry{SKY_CUBE, "", static_cast<std::uint32_t>(cube.size), static_cast<std::uint32_t>(6 * cube.size),
+                                    0.0f, 0.0f, cube.data(), sizeof(Color)});
+            entries.push_back(Entry{SKY_PREFILTERED, "", static_cast<std::uint32_t>(prefiltered.size),
+                                    static_cast<std::uint32_t>(6 * prefiltered.size), 0.0f, 0.0f, prefiltered.data(), sizeof(Radiance)});
+        }
+
+        // El directorio lleva el desplazamiento de cada bloque, así que se
+        // calculan antes de escribir nada
+        std::uint64_t offset = 3 * sizeof(std::uint32_t);
+        for (const Entry& entry : entries) {
+            offset += 6 * sizeof(std::uint32_t) + entry.key.size() + 2 * sizeof(std::uint64_t);
+        }
+        for (Entry& entry : entries) {
+            if (entry.width > MAX_SIDE || entry.height > 6 * MAX_SIDE) {
+                throw std::runtime_error("Texture too large for an asset pack: " + entry.key);
+            }
+            offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            entry.offset = offset;
+            offset += entry.bytes();
+        }
+
+        BinaryWriter out(path, ALIGNMENT);
+        out.put(MAGIC);
+        out.put(VERSION);
+        out.put(static_cast<std::uint32_t>(entries.size()));
+        for (const Entry& entry : entries) {
+            out.put(entry.kind);
+            out.putString(entry.key);
+            out.put(entry.width);
+            out.put(entry.height);
+            out.put(entry.sizeX);
+            out.put(entry.sizeY);
+            out.put(entry.offset);
+            out.put(entry.bytes());
+        }
+        for (const Entry& entry : entries) {
+            out.align();
+            if (out.offset() != entry.offset) {
+                throw std::runtime_error("Asset pack layout mismatch in " + path);
+            }
+            out.putArray(static_cast<const std::uint8_t*>(entry.texels), entry.bytes());
+        }
+        out.finish();
+    }
+
+    // Proyecta `path` y registra sus texturas en ImageLoader (reemplazando las
+    // de la misma clave) y, si las trae, los mapas del cielo. Va antes de
+    // loadAssets(), que ya no lee del disco las claves que vinieron del paquete.
+    static Summary load(const std::string& path) {
+        auto file = std::make_unique<MappedFile>(path);
+        BinaryReader in(file->data(), file->size(), ALIGNMENT, path);
+        if (in.get<std::uint32_t>() != MAGIC || in.get<std::uint32_t>() != VERSION) {
+            throw std::runtime_error(path + " is not an asset pack of this version");
+        }
+
+        std::uint32_t count = in.get<std::uint32_t>();
+        std::vector<Entry> entries;
+        for (std::uint32_t i = 0; i < count; i++) {
+            Entry entry;
+            entry.kind = in.get<std::uint32_t>();
+            entry.key = in.getString();
+            entry.width = in.get<std::uint32_t>();
+            entry.height = in.get<std::uint32_t>();
+            entry.sizeX = in.get<float>();
+            entry.sizeY = in.get<float>();
+            entry.offset = in.get<std::uint64_t>();
+            std::uint64_t bytes = in.get<std::uint64_t>();
+            // Lados acotados antes de multiplicarlos (el cielo apila seis caras);
+            // la escala de una textura va a fmod en Texture::sample
+            in.check(entry.kind <= SKY_PREFILTERED && entry.width > 0 && entry.width <= MAX_SIDE && entry.height > 0 &&
+                     entry.height <= 6 * MAX_SIDE && entry.offset % ALIGNMENT == 0);
+            in.check(entry.kind != TEXTURE || (std::isfinite(entry.sizeX) && std::isfinite(entry.sizeY) &&
+                                               entry.sizeX > 0.0f && entry.sizeY > 0.0f));
+            entry.texelSize = (entry.kind == SKY_PREFILTERED) ? sizeof(Radiance) : sizeof(Color);
+            in.check(bytes == entry.bytes());
+            entry.texels = in.view(entry.offset, bytes);
+            entries.push_back(entry);
+        }
+
+        Summary summary;
+        summary.bytes = file->size();
+        const Entry* cube = nullptr;
+        const Entry* prefiltered = nullptr;
+        for (const Entry& entry : entries) {
+            if (entry.kind == TEXTURE) {
+                Texture texture;
+                texture.width = static_cast<int>(entry.width);
+                texture.height = static_cast<int>(entry.height);
+                texture.size = glm::vec2(entry.sizeX, entry.sizeY);
+                texture.mapped = static_cast<const Color*>(entry.texels);
+                ImageLoader::addTexture(entry.key, std::move(texture));
+                summary.textures++;
+            } else if (entry.kind == SKY_CUBE && entry.height == 6 * entry.width) {
+                cube = &entry;
+            } else if (entry.kind == SKY_PREFILTERED && entry.height == 6 * entry.width) {
+                prefiltered = &entry;
+            }
+        }
+        if (cube && prefiltered) {
+            summary.sky = Skybox::useBaked(static_cast<int>(cube->width), static_cast<const Color*>(cube->texels),
+                                           static_cast<int>(prefiltered->width), static_cast<const Radiance*>(prefiltered->texels));
+        }
+
+        // Las texturas apuntan dentro de la proyección: vive hasta el final del programa
+        files.push_back(std::move(file));
+        return summary;
+    }
+
+private:
+    static constexpr std::uint32_t MAGIC = 0x50315253; // "SR1P"
+    static constexpr std::uint32_t VERSION = 1;
+    // Cada bloque empieza en su propia línea de caché
+    static constexpr size_t ALIGNMENT = 64;
+    // Lado máximo de una textura o de una cara del cielo, en texels
+    static constexpr std::uint32_t MAX_SIDE = 1 << 16;
+
+    enum Kind : std::uint32_t { TEXTURE, SKY_CUBE, SKY_PREFILTERED };
+
+    struct Entry {
+        std::uint32_t kind = TEXTURE;
+        std::string key;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        float sizeX = 0.0f;
+        float sizeY = 0.0f;
+        const void* texels = nullptr;
+        std::uint64_t texelSize = sizeof(Color);
+        std::uint64_t offset = 0;
+
+        std::uint64_t bytes() const {
+            return static_cast<std::uint64_t>(width) * height * texelSize;
+        }
+    };
+
+    inline static std::vector<std::unique_ptr<MappedFile>> files;
+};
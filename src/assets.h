@@ -0,0 +1,113 @@
+#pragma once
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+#include "diorama.h"
+#include "imagefile.h"
+#include "scenefile.h"
+#include "skybox.h"
+#include "threadpool.h"
+#include "timeline.h"
+
+// Una imagen a registrar: clave, archivo y tamaño con el que se escalan las coordenadas
+struct TextureRequest {
+    std::string key;
+    std::string path;
+    float width;
+    float height;
+};
+
+// Proyecta el paquete de --pack; va antes de loadAssets(), que ya no lee del
+// disco las claves que vinieron del paquete
+inline void loadPack(const std::string& path, std::ostream& log) {
+    StartupTimeline::Scope timing("proyectar " + path);
+    auto start = std::chrono::steady_clock::now();
+    AssetPack::Summary pack = AssetPack::load(path);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    log << "Paquete " << path << ": " << pack.textures << " texturas" << (pack.sky ? " y el cielo horneado" : "") << ", "
+        << pack.bytes / (1024.0 * 1024.0) << " MB proyectados en " << ms << " ms" << std::endl;
+}
+
+// Registra las imágenes de `requests` y prepara el cielo. Las del cielo quedan
+// diferidas: se decodifican cuando se hornea la primera cara que las usa. El
+// resto se decodifica en paralelo en `threads` hilos (0: todos los núcleos) y
+// se registra en el orden pedido, así que los handles no dependen de qué hilo
+// terminó primero.
+inline void loadTextures(const std::vector<TextureRequest>& requests, unsigned threads) {
+    ImageFile::init();
+    std::vector<const TextureRequest*> eager;
+    for (const TextureRequest& request : requests) {
+        if (ImageLoader::isMapped(request.key)) {
+            continue;
+        }
+        if (!Skybox::isSource(request.key)) {
+            eager.push_back(&request);
+            continue;
+        }
+        // Un archivo que falta se avisa al arrancar, no en medio de un cuadro
+        if (!std::filesystem::exists(request.path)) {
+            throw std::runtime_error("Unable to load image " + request.path);
+        }
+        ImageLoader::addDeferred(request.key, glm::vec2(request.width, request.height), [request] {
+            StartupTimeline::Scope timing("decodificar " + request.key + " (diferida)");
+            try {
+                return ImageFile::read(request.path);
+            } catch (const std::exception& error) {
+                // Se pide desde un hilo del render: no hay a quién pasarle el error
+                std::cerr << "Error: " << error.what() << std::endl;
+                Texture missing;
+                missing.width = 1;
+                missing.height = 1;
+                missing.texels.assign(1, Color(255, 0, 255));
+                return missing;
+            }
+        });
+    }
+
+    std::vector<Texture> decoded(eager.size());
+    std::vector<std::exception_ptr> errors(eager.size());
+    {
+        StartupTimeline::Scope timing("decodificar " + std::to_string(eager.size()) + " texturas");
+        ThreadPool pool(threads);
+        pool.parallelFor(static_cast<int>(eager.size()), [&](int i) {
+            StartupTimeline::Scope textureTiming("decodificar " + eager[i]->key);
+            try {
+                decoded[i] = ImageFile::read(eager[i]->path);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (size_t i = 0; i < eager.size(); i++) {
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
+        }
+        decoded[i].size = glm::vec2(eager[i]->width, eager[i]->height);
+        ImageLoader::addTexture(eager[i]->key, std::move(decoded[i]));
+    }
+    Skybox::loadTextures();
+}
+
+// Texturas de la diorama y el cielo; llamar antes de setUp()
+inline void loadAssets(unsigned threads = 0) {
+    std::vector<TextureRequest> requests;
+    for (const TextureEntry& entry : DIORAMA_TEXTURES) {
+        requests.push_back(TextureRequest{entry.key, entry.path, entry.width, entry.height});
+    }
+    loadTextures(requests, threads);
+}
+
+// Texturas de una escena de archivo y el cielo
+inline void loadAssets(const SceneDocument& document, unsigned threads = 0) {
+    std::vector<TextureRequest> requests;
+    for (const TextureBinding& texture : document.textures) {
+        requests.push_back(TextureRequest{texture.key, document.texturePath(texture), texture.width, texture.height});
+    }
+    loadTextures(requests, threads);
+}
@@ -0,0 +1,449 @@
+// sr1_bench: renderiza escenas fijas por recorridos de cámara fijos y escribe
+// los tiempos en JSON, para comparar el rendimiento entre commits.
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "assets.h"
+#include "cachecounters.h"
+#include "camera.h"
+#include "diorama.h"
+#include "framebuffer.h"
+#include "globals.h"
+#include "imageloader.h"
+#include "options.h"
+#include "raypacket.h"
+#include "renderer.h"
+#include "scenefile.h"
+#include "timeline.h"
+
+#ifndef SR1_COMMIT
+#define SR1_COMMIT "unknown"
+#endif
+
+namespace {
+
+// Escena a medir: "diorama", "terrain:N" (N x N columnas generadas) o un
+// archivo de escena
+struct SceneSpec {
+    std::string name = "";
+    int terrainSize = 0;
+    bool isFile = false;
+    SceneDocument document = {};
+};
+
+// Recorridos de cámara alrededor de la caja de la escena, en `frames` cuadros
+enum class CameraPath {
+    Orbit,  // vuelta completa alrededor del centro, a media altura
+    Dolly,  // se acerca en línea recta al centro desde el doble de distancia
+    Strafe, // se desplaza de lado frente a la escena mirando de frente
+};
+
+const char* pathName(CameraPath path) {
+    switch (path) {
+        case CameraPath::Dolly:
+            return "dolly";
+        case CameraPath::Strafe:
+            return "strafe";
+        default:
+            return "orbit";
+    }
+}
+
+// Centro y radio de la caja de la escena, alrededor de los que van los recorridos
+struct Bounds {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// La caja se acumula en double: en float, una escena con bloques enormes (o
+// un archivo dañado) desborda el radio a inf y la cámara quedaría en inf o NaN.
+// La cámara normaliza vectores de su posición al centro, que elevan las
+// distancias al cuadrado, así que la más lejana (el doble del radio, en dolly)
+// tiene que quedar bajo MAX_PATH_EXTENT; si no, la escena se rechaza.
+constexpr double MAX_PATH_EXTENT = 1e18;
+
+Bounds sceneBounds(const Scene& scene, const std::string& name) {
+    Bounds bounds;
+    if (scene.size() == 0) {
+        bounds.radius = 1.0f;
+        return bounds;
+    }
+    double min[3] = {1e30, 1e30, 1e30};
+    double max[3] = {-1e30, -1e30, -1e30};
+    for (int id = 0; id < scene.size(); id++) {
+        AABB box = scene.bounds(id);
+        for (int axis = 0; axis < 3; axis++) {
+            if (!std::isfinite(box.min[axis]) || !std::isfinite(box.max[axis])) {
+                throw std::runtime_error("Scene has non-finite bounds: " + name);
+            }
+            min[axis] = std::min(min[axis], static_cast<double>(box.min[axis]));
+            max[axis] = std::max(max[axis], static_cast<double>(box.max[axis]));
+        }
+    }
+    double center[3];
+    double lengthSquared = 0.0;
+    for (int axis = 0; axis < 3; axis++) {
+        center[axis] = (min[axis] + max[axis]) * 0.5;
+        lengthSquared += (max[axis] - min[axis]) * (max[axis] - min[axis]);
+    }
+    double radius = std::sqrt(lengthSquared) * 0.5;
+    double farthest = 0.0;
+    for (int axis = 0; axis < 3; axis++) {
+        farthest = std::max(farthest, std::abs(center[axis]) + 2.0 * radius);
+    }
+    if (!(farthest <= MAX_PATH_EXTENT)) {
+        throw std::runtime_error("Scene is too large for the camera paths: " + name);
+    }
+    bounds.center = glm::vec3(center[0], center[1], center[2]);
+    bounds.radius = static_cast<float>(radius);
+    return bounds;
+}
+
+Camera pathCamera(CameraPath path, const Bounds& bounds, int frame, int frames) {
+    glm::vec3 center = bounds.center;
+    float radius = bounds.radius;
+    float t = frames > 1 ? static_cast<float>(frame) / (frames - 1) : 0.0f;
+    glm::vec3 up(0.0f, 1.0f, 0.0f);
+    switch (path) {
+        case CameraPath::Dolly: {
+            glm::vec3 direction = glm::normalize(glm::vec3(-0.3f, 0.25f, 1.0f));
+            float distance = radius * (2.0f - t);
+            return Camera(center + direction * distance, center, up, 10.0f);
+        }
+        case CameraPath::Strafe: {
+            glm::vec3 offset((t - 0.5f) * radius, radius * 0.3f, radius * 1.2f);
+            return Camera(center + offset, center + glm::vec3(offset.x, 0.0f, 0.0f), up, 10.0f);
+        }
+        default: {
+            float angle = 2.0f * 3.14159265f * frame / frames;
+            glm::vec3 offset(std::sin(angle) * radius * 1.2f, radius * 0.4f, std::cos(angle) * radius * 1.2f);
+            return Camera(center + offset, center, up, 10.0f);
+        }
+    }
+}
+
+struct Percentiles {
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Percentiles por rango más cercano
+Percentiles percentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+    auto rank = [&values](double fraction) {
+        size_t index = static_cast<size_t>(std::ceil(fraction * values.size()));
+        return values[std::clamp<size_t>(index, 1, values.size()) - 1];
+    };
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    result.mean = sum / values.size();
+    result.median = rank(0.5);
+    result.p95 = rank(0.95);
+    result.min = values.front();
+    result.max = values.back();
+    return result;
+}
+
+std::string jsonPercentiles(const Percentiles& p) {
+    std::ostringstream out;
+    out << "{\"mean\": " << p.mean << ", \"median\": " << p.median << ", \"p95\": " << p.p95
+        << ", \"min\": " << p.min << ", \"max\": " << p.max << "}";
+    return out.str();
+}
+
+// FNV-1a de 64 bits sobre los bytes de los píxeles, encadenado entre cuadros
+uint64_t imageChecksum(const Framebuffer& image, uint64_t hash) {
+    for (const Color& pixel : image.pixels) {
+        for (std::uint8_t byte : {pixel.r, pixel.g, pixel.b, pixel.a}) {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+constexpr uint64_t CHECKSUM_SEED = 14695981039346656037ull;
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+struct Options {
+    std::vector<SceneSpec> scenes;
+    std::vector<CameraPath> paths;
+    std::vector<std::pair<int, int>> sizes;
+    int frames = 24;
+    int warmup = 4;
+    int repetitions = 3;
+    unsigned threads = 0;
+    std::string output;
+    std::string pack; // paquete de texturas (--pack), "" lee los PNG
+};
+
+// Mide una escena ya armada en `renderer` por un recorrido; devuelve el objeto JSON
+std::string runPath(Renderer& renderer, const SceneSpec& spec, CameraPath path, const Options& options, const CacheCounters& cache) {
+    Bounds bounds = sceneBounds(renderer.scene, spec.name);
+    Framebuffer image(renderer.getWidth(), renderer.getHeight());
+    auto renderFrame = [&](int frame) {
+        renderer.beginFrame(pathCamera(path, bounds, frame, options.frames), image);
+        renderer.endFrame();
+    };
+
+    // Calentamiento: caché, páginas de memoria y frecuencia del procesador
+    for (int frame = 0; frame < options.warmup; frame++) {
+        renderFrame(frame % options.frames);
+    }
+    renderer.collectFrameStats();
+
+    std::vector<double> frameMs;
+    std::vector<double> reprojectMs, traceMs, tonemapMs;
+    Counters::Totals totals;
+    double totalMs = 0.0;
+    // Cada pasada tiene que dar las mismas imágenes: el checksum de la primera
+    // va al JSON y las demás se comparan con él
+    std::vector<uint64_t> checksums;
+    CacheCounters::Reading cacheStart = cache.read();
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+        uint64_t checksum = CHECKSUM_SEED;
+        for (int frame = 0; frame < options.frames; frame++) {
+            auto start = std::chrono::steady_clock::now();
+            renderFrame(frame);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            Renderer::FrameStats stats = renderer.collectFrameStats();
+            frameMs.push_back(ms);
+            reprojectMs.push_back(stats.reprojectMs);
+            traceMs.push_back(stats.traceMs);
+            tonemapMs.push_back(stats.tonemapMs);
+            for (int i = 0; i < Counters::COUNT; i++) {
+                totals.values[i] += stats.counters[i];
+            }
+            totalMs += ms;
+            checksum = imageChecksum(image, checksum);
+        }
+        checksums.push_back(checksum);
+    }
+
+    CacheCounters::Reading cacheEnd = cache.read();
+
+    bool deterministic = std::all_of(checksums.begin(), checksums.end(), [&](uint64_t c) { return c == checksums.front(); });
+    if (!deterministic) {
+        std::cerr << "Aviso: " << spec.name << ", " << pathName(path) << ": las pasadas dieron imágenes distintas" << std::endl;
+    }
+    char checksumText[17];
+    std::snprintf(checksumText, sizeof(checksumText), "%016llx", static_cast<unsigned long long>(checksums.front()));
+
+    uint64_t measuredFrames = static_cast<uint64_t>(options.frames) * options.repetitions;
+    // Los contadores de caché cubren también lo que hagan otros hilos del proceso en el intervalo
+    std::string cacheMisses = "null";
+    std::string cacheReferences = "null";
+    if (cache.available()) {
+        cacheMisses = std::to_string((cacheEnd.misses - cacheStart.misses) / measuredFrames);
+        cacheReferences = std::to_string((cacheEnd.references - cacheStart.references) / measuredFrames);
+    }
+    size_t primitives = static_cast<size_t>(std::max(renderer.scene.size(), 1));
+    uint64_t rays = totals.rays();
+    std::ostringstream depths;
+    for (int depth = 0; depth <= MAX_RECURSION; depth++) {
+        depths << (depth > 0 ? ", " : "") << totals[Counters::DEPTH_0 + depth] / measuredFrames;
+    }
+    std::ostringstream out;
+    out << "    {\"scene\": " << jsonString(spec.name) << ", \"primitives\": " << renderer.scene.size()
+        << ", \"width\": " << renderer.getWidth() << ", \"height\": " << renderer.getHeight()
+        << ", \"path\": " << jsonString(pathName(path)) << ", \"frames\": " << options.frames
+        << ", \"warmup\": " << options.warmup << ", \"repetitions\": " << options.repetitions << ",\n"
+        << "     \"imageChecksum\": " << jsonString(checksumText) << ", \"deterministic\": " << (deterministic ? "true" : "false") << ",\n"
+        << "     \"buildMs\": " << renderer.acceleratorBuildMs() << ",\n"
+        << "     \"bytesPerPrimitive\": {\"scene\": " << renderer.scene.memoryBytes() / primitives
+        << ", \"accelerator\": " << renderer.acceleratorBytes() / primitives << "},\n"
+        << "     \"msPerFrame\": " << jsonPercentiles(percentiles(frameMs)) << ",\n"
+        << "     \"raysPerSecond\": " << (totalMs > 0.0 ? rays * 1000.0 / totalMs : 0.0) << ",\n"
+        << "     \"raysPerFrame\": {\"primary\": " << totals[Counters::PRIMARY_RAYS] / measuredFrames
+        << ", \"shadow\": " << totals[Counters::SHADOW_RAYS] / measuredFrames
+        << ", \"reflect\": " << totals[Counters::REFLECT_RAYS] / measuredFrames
+        << ", \"refract\": " << totals[Counters::REFRACT_RAYS] / measuredFrames
+        << ", \"skybox\": " << totals[Counters::SKYBOX_RAYS] / measuredFrames << "},\n"
+        << "     \"intersectionTestsPerFrame\": " << totals[Counters::INTERSECTION_TESTS] / measuredFrames
+        << ", \"textureFetchesPerFrame\": " << totals[Counters::TEXTURE_FETCHES] / measuredFrames
+        << ", \"raysPerDepth\": [" << depths.str() << "],\n"
+        << "     \"cacheMissesPerFrame\": " << cacheMisses << ", \"cacheReferencesPerFrame\": " << cacheReferences << ",\n"
+        << "     \"stageMs\": {\"reproject\": " << jsonPercentiles(percentiles(reprojectMs)) << ",\n"
+        << "                 \"trace\": " << jsonPercentiles(percentiles(traceMs)) << ",\n"
+        << "                 \"tonemap\": " << jsonPercentiles(percentiles(tonemapMs)) << "}}";
+    return out.str();
+}
+
+bool parseOptions(int argc, char* argv[], Options& options, Renderer& settings) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--scene" && hasValue) {
+            std::string name = argv[++i];
+            SceneSpec spec;
+            spec.name = name;
+            if (name.rfind("terrain:", 0) == 0) {
+                spec.terrainSize = std::atoi(name.c_str() + 8);
+            } else if (name != "diorama") {
+                spec.isFile = true;
+            }
+            options.scenes.push_back(spec);
+        } else if (option == "--path" && hasValue) {
+            std::string name = argv[++i];
+            options.paths.push_back(name == "dolly" ? CameraPath::Dolly : name == "strafe" ? CameraPath::Strafe : CameraPath::Orbit);
+        } else if (option == "--size" && hasValue) {
+            int width, height;
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                std::cerr << "Error: --size espera ANCHOxALTO" << std::endl;
+                return false;
+            }
+            options.sizes.emplace_back(width, height);
+        } else if (option == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--warmup" && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (option == "--reps" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--threads" && hasValue) {
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (option == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else if (option == "--pack" && hasValue) {
+            options.pack = argv[++i];
+        } else if (!parseRenderOption(settings, argc, argv, i)) {
+            std::cerr << "Aviso: opción ignorada: " << option << std::endl;
+        }
+    }
+    if (options.scenes.empty()) {
+        SceneSpec diorama;
+        diorama.name = "diorama";
+        SceneSpec terrain;
+        terrain.name = "terrain:64";
+        terrain.terrainSize = 64;
+        options.scenes = {diorama, terrain};
+    }
+    if (options.paths.empty()) {
+        options.paths = {CameraPath::Orbit, CameraPath::Dolly, CameraPath::Strafe};
+    }
+    if (options.sizes.empty()) {
+        options.sizes = {{640, 360}, {1280, 720}};
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    StartupTimeline::start();
+    // Antes de crear cualquier pool, para que cuenten también sus hilos
+    CacheCounters cacheCounters;
+    Options options;
+    // Las opciones de render se leen una vez sobre este Renderer y se repiten
+    // en cada uno de los que se crean por resolución
+    Renderer settings(1, 1);
+    if (!parseOptions(argc, argv, options, settings)) {
+        return 1;
+    }
+
+    std::vector<std::string> runs;
+    try {
+        if (!options.pack.empty()) {
+            loadPack(options.pack, std::cerr);
+        }
+        loadAssets(options.threads);
+        for (SceneSpec& spec : options.scenes) {
+            if (spec.isFile) {
+                spec.document = SceneFile::open(spec.name);
+                loadAssets(spec.document, options.threads);
+            }
+        }
+        ImageLoader::freeze();
+
+        for (const SceneSpec& spec : options.scenes) {
+            for (const auto& size : options.sizes) {
+                auto renderer = std::make_unique<Renderer>(size.first, size.second);
+                for (int i = 1; i < argc; i++) {
+                    parseRenderOption(*renderer, argc, argv, i);
+                }
+                // Sin progresivo (depende del reloj) ni reproyección: cada cuadro
+                // se traza completo y la misma corrida traza los mismos rayos
+                renderer->progressive.setEnabled(false);
+                renderer->reprojection.setEnabled(false);
+                if (spec.isFile) {
+                    spec.document.apply(*renderer);
+                } else if (spec.terrainSize > 0) {
+                    generateTerrain(renderer->scene, spec.terrainSize, 1u);
+                } else {
+                    setUp(renderer->scene);
+                }
+                renderer->start(options.threads);
+                if (spec.isFile && &size == &options.sizes.front()) {
+                    SceneFile::updateCache(spec.document, *renderer, std::cerr);
+                }
+
+                for (CameraPath path : options.paths) {
+                    std::cerr << spec.name << " " << size.first << "x" << size.second << " " << pathName(path) << "..." << std::endl;
+                    runs.push_back(runPath(*renderer, spec, path, options, cacheCounters));
+                }
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    // Carga de texturas, construcción de aceleradores y caras del cielo horneadas al primer uso
+    StartupTimeline::report(std::cerr, "Carga");
+
+    std::ostringstream json;
+    json << "{\n  \"commit\": " << jsonString(SR1_COMMIT) << ",\n"
+         << "  \"threads\": " << (options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency())) << ",\n"
+         << "  \"packetSize\": " << PACKET_SIZE << ",\n"
+         << "  \"counters\": " << (Counters::enabled ? "true" : "false") << ",\n"
+         << "  \"cacheCounters\": " << (cacheCounters.available() ? "true" : "false") << ",\n"
+         << "  \"accelerator\": " << jsonString(settings.acceleratorName()) << ",\n"
+         << "  \"runs\": [\n";
+    for (size_t i = 0; i < runs.size(); i++) {
+        json << runs[i] << (i + 1 < runs.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (options.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.output);
+        file << json.str();
+        if (!file) {
+            std::cerr << "Error: no se pudo escribir " << options.output << std::endl;
+            return 1;
+        }
+    }
+    ImageFile::quit();
+    return 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Escritura secuencial de los archivos binarios propios (caché de escena,
+// paquete de texturas): valores sueltos, cadenas con largo y arreglos
+// alineados a `alignment` bytes desde el comienzo del archivo.
+class BinaryWriter {
+public:
+    BinaryWriter(const std::string& path, size_t alignment) : path(path), alignment(alignment), file(path, std::ios::binary) {
+        if (!file) {
+            throw std::runtime_error("Unable to open " + path + " for writing");
+        }
+    }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(&value, sizeof(T));
+    }
+
+    void putString(const std::string& text) {
+        put(static_cast<std::uint32_t>(text.size()));
+        write(text.data(), text.size());
+    }
+
+    template <typename T>
+    void putArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        align();
+        write(values, count * sizeof(T));
+    }
+
+    // Rellena con ceros hasta el próximo múltiplo de la alineación
+    void align() {
+        static const char padding[256] = {};
+        write(padding, (alignment - position % alignment) % alignment);
+    }
+
+    size_t offset() const {
+        return position;
+    }
+
+    void finish() {
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Unable to write " + path);
+        }
+    }
+
+private:
+    void write(const void* data, size_t size) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position += size;
+    }
+
+    std::string path;
+    size_t alignment;
+    std::ofstream file;
+    size_t position = 0;
+};
+
+// Lectura de lo que escribe BinaryWriter sobre bytes ya en memoria (un archivo
+// proyectado). Cualquier lectura fuera de los bytes rechaza el archivo.
+class BinaryReader {
+public:
+    BinaryReader(const std::uint8_t* data, size_t size, size_t alignment, const std::string& path)
+        : data(data), size(size), alignment(alignment), path(path) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string getString() {
+        std::uint32_t length = get<std::uint32_t>();
+        return std::string(reinterpret_cast<const char*>(take(length)), length);
+    }
+
+    // Copia `count` elementos alineados
+    template <typename T>
+    void getArray(std::vector<T>& values, size_t count) {
+        take((alignment - offset % alignment) % alignment);
+        check(count <= size / sizeof(T));
+        values.resize(count);
+        if (count > 0) {
+            std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+        }
+    }
+
+    // Bytes [start, start + length) sin copiar, con su rango verificado
+    const std::uint8_t* view(std::uint64_t start, std::uint64_t length) const {
+        check(start <= size && length <= size - start);
+        return data + start;
+    }
+
+    void check(bool valid) const {
+        if (!valid) {
+            throw std::runtime_error("Corrupt file " + path);
+        }
+    }
+
+private:
+    const std::uint8_t* take(size_t length) {
+        check(length <= size - offset);
+        const std::uint8_t* start = data + offset;
+        offset += length;
+        return start;
+    }
+
+    const std::uint8_t* data;
+    size_t size;
+    size_t alignment;
+    size_t offset = 0;
+    std::string path;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "imageloader.h"
+#include "material.h"
+
+// Texturas por cara de un bloque; NO_TEXTURE usa el color del material
+struct FaceTextures {
+  TextureHandle top = NO_TEXTURE;
+  TextureHandle side = NO_TEXTURE;
+  TextureHandle bottom = NO_TEXTURE;
+};
+
+// Índice en la tabla de tipos de bloque de la escena
+using BlockId = uint16_t;
+
+// Un tipo de bloque (pasto, tronco, tablas...): sus texturas y su material.
+// Agregar un tipo nuevo es agregar una fila a la tabla, sin clases nuevas.
+struct BlockType {
+  std::string name;
+  FaceTextures textures;
+  Material material;
+};
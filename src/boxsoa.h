@@ -0,0 +1,283 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include "aabb.h"
+#include "ray.h"
+#include "raybox.h"
+#include "raypacket.h"
+
+// Cajas guardadas como estructura de arreglos (minX[], minY[], ...) para probar
+// un rayo contra PACKET_SIZE cajas por instrucción. `ids` identifica a cada caja
+// (el primitivo de la escena) y decide los empates: gana el id menor.
+// Las siete columnas viven en una sola reserva alineada, una detrás de otra y
+// cada una desde su propia línea de caché, así que la tabla se libera de una
+// vez y su disposición depende solo de la capacidad. Cada columna lleva
+// PACKET_SIZE elementos de relleno en cero para leer tandas completas.
+struct BoxSoA {
+  float* minX = nullptr;
+  float* minY = nullptr;
+  float* minZ = nullptr;
+  float* maxX = nullptr;
+  float* maxY = nullptr;
+  float* maxZ = nullptr;
+  int* ids = nullptr;
+
+  BoxSoA() = default;
+
+  BoxSoA(const BoxSoA& other) {
+    *this = other;
+  }
+
+  BoxSoA(BoxSoA&& other) noexcept {
+    swap(other);
+  }
+
+  BoxSoA& operator=(const BoxSoA& other) {
+    if (this != &other) {
+      clear();
+      relayout(other.count);
+      copyColumns(other, other.count);
+      count = other.count;
+    }
+    return *this;
+  }
+
+  BoxSoA& operator=(BoxSoA&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  int size() const {
+    return count;
+  }
+
+  // Libera la reserva entera
+  void clear() {
+    storage.reset();
+    count = 0;
+    capacity = 0;
+    pointColumns();
+  }
+
+  // Deja lugar para `total` cajas sin volver a reservar
+  void reserve(int total) {
+    if (total > capacity) {
+      relayout(total);
+    }
+  }
+
+  // Ajusta la reserva a las cajas que hay
+  void shrinkToFit() {
+    if (capacity > count) {
+      relayout(count);
+    }
+  }
+
+  // Bytes reservados, relleno incluido
+  size_t bytes() const {
+    return capacity > 0 ? COLUMN_COUNT * columnBytes(capacity) : 0;
+  }
+
+  void push(const AABB& box, int id) {
+    if (count == capacity) {
+      relayout(std::max(2 * capacity, MIN_CAPACITY));
+    }
+    minX[count] = box.min.x;
+    minY[count] = box.min.y;
+    minZ[count] = box.min.z;
+    maxX[count] = box.max.x;
+    maxY[count] = box.max.y;
+    maxZ[count] = box.max.z;
+    ids[count] = id;
+    count++;
+  }
+
+  // Agrega `count` cajas ya separadas en columnas (min x, y, z, max x, y, z),
+  // con ids consecutivos desde `firstId`
+  void append(int added, const float* const columns[6], int firstId) {
+    reserve(count + added);
+    float* targets[6] = {minX, minY, minZ, maxX, maxY, maxZ};
+    for (int c = 0; c < 6; c++) {
+      std::copy(columns[c], columns[c] + added, targets[c] + count);
+    }
+    for (int i = 0; i < added; i++) {
+      ids[count + i] = firstId + i;
+    }
+    count += added;
+  }
+
+  AABB box(int i) const {
+    return AABB{glm::vec3(minX[i], minY[i], minZ[i]), glm::vec3(maxX[i], maxY[i], maxZ[i])};
+  }
+
+  // Una caja: mismo slab test que rayBox, con la distancia dentro de [tMin, tMax]
+  bool intersect(int i, const Ray& ray, float& dist) const {
+    float tNear, tFar;
+    return box(i).intersect(ray, tNear, tFar) && clipToRay(ray, tNear, tFar, dist);
+  }
+
+  // Impacto más cercano entre las cajas [begin, end), saltando el id `ignore`.
+  // Cada impacto achica ray.tMax; closestIndex (índice en este arreglo) queda en
+  // la caja ganadora si alguna mejora.
+  void closest(Ray& ray, int begin, int end, int ignore, int& closestIndex) const {
+    RayLanes lanes(*this, ray);
+    alignas(32) float dist[PACKET_SIZE];
+    for (int i = begin; i < end; i += PACKET_SIZE) {
+      int mask = batch(lanes, i, end, dist);
+      mask &= lanesMask(lanesNotGreater(lanesLoad(dist), lanesSet(ray.tMax)));
+      while (mask) {
+        int lane = std::countr_zero(static_cast<unsigned>(mask));
+        mask &= mask - 1;
+        int index = i + lane;
+        if (ids[index] == ignore) {
+          continue;
+        }
+        if (dist[lane] < ray.tMax || (dist[lane] == ray.tMax && (closestIndex < 0 || ids[index] < ids[closestIndex]))) {
+          ray.tMax = dist[lane];
+          closestIndex = index;
+        }
+      }
+    }
+  }
+
+  // Oclusor más cercano entre las cajas [begin, end): impacto en el intervalo
+  // abierto (tMin, tMax), saltando el id `ignore`. Como closest(), cada impacto
+  // achica ray.tMax y occluderIndex queda en la caja si alguna mejora; la
+  // distancia final no depende del orden en que se prueban las cajas.
+  void occluder(Ray& ray, int begin, int end, int ignore, int& occluderIndex) const {
+    RayLanes lanes(*this, ray);
+    alignas(32) float dist[PACKET_SIZE];
+    for (int i = begin; i < end; i += PACKET_SIZE) {
+      int mask = batch(lanes, i, end, dist);
+      Lanes laneDist = lanesLoad(dist);
+      mask &= lanesMask(lanesAnd(lanesLess(lanesSet(ray.tMin), laneDist), lanesLess(laneDist, lanesSet(ray.tMax))));
+      while (mask) {
+        int lane = std::countr_zero(static_cast<unsigned>(mask));
+        mask &= mask - 1;
+        if (ids[i + lane] != ignore && dist[lane] < ray.tMax) {
+          ray.tMax = dist[lane];
+          occluderIndex = i + lane;
+        }
+      }
+    }
+  }
+
+private:
+  // El rayo repetido en todos los carriles. Los signos eligen una sola vez qué
+  // columna da el plano cercano de cada eje, así el slab test no necesita min/max
+  // por caja.
+  struct RayLanes {
+    Lanes originX, originY, originZ;
+    Lanes invDirX, invDirY, invDirZ;
+    Lanes tMin;
+    const float *nearX, *nearY, *nearZ;
+    const float *farX, *farY, *farZ;
+
+    RayLanes(const BoxSoA& boxes, const Ray& ray)
+      : originX(lanesSet(ray.origin.x)), originY(lanesSet(ray.origin.y)), originZ(lanesSet(ray.origin.z)),
+        invDirX(lanesSet(ray.invDir.x)), invDirY(lanesSet(ray.invDir.y)), invDirZ(lanesSet(ray.invDir.z)),
+        tMin(lanesSet(ray.tMin)),
+        nearX(ray.sign[0] ? boxes.maxX : boxes.minX),
+        nearY(ray.sign[1] ? boxes.maxY : boxes.minY),
+        nearZ(ray.sign[2] ? boxes.maxZ : boxes.minZ),
+        farX(ray.sign[0] ? boxes.minX : boxes.maxX),
+        farY(ray.sign[1] ? boxes.minY : boxes.maxY),
+        farZ(ray.sign[2] ? boxes.minZ : boxes.maxZ) {}
+  };
+
+  // Slab test de un rayo contra las cajas [i, i + PACKET_SIZE); devuelve la
+  // máscara de cajas cruzadas a partir de tMin (solo las anteriores a `end`) y
+  // sus distancias (tFar si el rayo empieza adentro).
+  int batch(const RayLanes& ray, int i, int end, float* dist) const {
+    Lanes tNearX = lanesMul(lanesSub(lanesLoadUnaligned(ray.nearX + i), ray.originX), ray.invDirX);
+    Lanes tNearY = lanesMul(lanesSub(lanesLoadUnaligned(ray.nearY + i), ray.originY), ray.invDirY);
+    Lanes tNearZ = lanesMul(lanesSub(lanesLoadUnaligned(ray.nearZ + i), ray.originZ), ray.invDirZ);
+    Lanes tFarX = lanesMul(lanesSub(lanesLoadUnaligned(ray.farX + i), ray.originX), ray.invDirX);
+    Lanes tFarY = lanesMul(lanesSub(lanesLoadUnaligned(ray.farY + i), ray.originY), ray.invDirY);
+    Lanes tFarZ = lanesMul(lanesSub(lanesLoadUnaligned(ray.farZ + i), ray.originZ), ray.invDirZ);
+
+    Lanes tNear = lanesMax(lanesMax(tNearX, tNearY), tNearZ);
+    Lanes tFar = lanesMin(lanesMin(tFarX, tFarY), tFarZ);
+
+    lanesStore(dist, lanesSelect(lanesLess(tNear, ray.tMin), tFar, tNear));
+    int valid = (1 << std::min(PACKET_SIZE, end - i)) - 1;
+    Lanes tFarLimit = lanesMul(tFar, lanesSet(SLAB_TOLERANCE));
+    return lanesMask(lanesAnd(lanesNotGreater(tNear, tFarLimit), lanesNotLess(tFar, ray.tMin))) & valid;
+  }
+
+  static constexpr size_t ALIGNMENT = 64;
+  static constexpr size_t COLUMN_COUNT = 7;
+  static constexpr int MIN_CAPACITY = 64;
+
+  struct AlignedDelete {
+    void operator()(std::byte* bytes) const {
+      ::operator delete[](bytes, std::align_val_t(ALIGNMENT));
+    }
+  };
+
+  // Bytes de una columna de `boxes` cajas más el relleno, redondeados a la línea de caché
+  static size_t columnBytes(int boxes) {
+    size_t used = (static_cast<size_t>(boxes) + PACKET_SIZE) * sizeof(float);
+    return (used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  // Pasa las cajas a una reserva nueva de `newCapacity`, en cero fuera de ellas
+  void relayout(int newCapacity) {
+    BoxSoA moved;
+    if (newCapacity > 0) {
+      size_t total = COLUMN_COUNT * columnBytes(newCapacity);
+      moved.storage.reset(static_cast<std::byte*>(::operator new[](total, std::align_val_t(ALIGNMENT))));
+      std::memset(moved.storage.get(), 0, total);
+      moved.capacity = newCapacity;
+      moved.pointColumns();
+      moved.copyColumns(*this, count);
+      moved.count = count;
+    }
+    swap(moved);
+  }
+
+  void pointColumns() {
+    std::byte* base = storage.get();
+    size_t stride = base ? columnBytes(capacity) : 0;
+    float** floats[6] = {&minX, &minY, &minZ, &maxX, &maxY, &maxZ};
+    for (int c = 0; c < 6; c++) {
+      *floats[c] = base ? reinterpret_cast<float*>(base + c * stride) : nullptr;
+    }
+    ids = base ? reinterpret_cast<int*>(base + 6 * stride) : nullptr;
+  }
+
+  void copyColumns(const BoxSoA& other, int boxes) {
+    if (boxes == 0) {
+      return;
+    }
+    const float* sources[6] = {other.minX, other.minY, other.minZ, other.maxX, other.maxY, other.maxZ};
+    float* targets[6] = {minX, minY, minZ, maxX, maxY, maxZ};
+    for (int c = 0; c < 6; c++) {
+      std::copy(sources[c], sources[c] + boxes, targets[c]);
+    }
+    std::copy(other.ids, other.ids + boxes, ids);
+  }
+
+  void swap(BoxSoA& other) noexcept {
+    std::swap(storage, other.storage);
+    std::swap(count, other.count);
+    std::swap(capacity, other.capacity);
+    std::swap(minX, other.minX);
+    std::swap(minY, other.minY);
+    std::swap(minZ, other.minZ);
+    std::swap(maxX, other.maxX);
+    std::swap(maxY, other.maxY);
+    std::swap(maxZ, other.maxZ);
+    std::swap(ids, other.ids);
+  }
+
+  std::unique_ptr<std::byte[], AlignedDelete> storage;
+  int count = 0;
+  int capacity = 0;
+};
@@ -0,0 +1,348 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "aabb.h"
+#include "accelerator.h"
+#include "boxsoa.h"
+#include "ray.h"
+
+struct BVHNode {
+  AABB bounds;
+  int leftOrFirst; // hoja: primer primitivo; interno: hijo izquierdo (el derecho va después)
+  int count;       // > 0 solo en hojas
+};
+
+// Jerarquía de volúmenes (SAH con bins) sobre los bloques de la escena.
+class BVH : public Accelerator {
+public:
+  // Profundidad máxima de una hoja (la raíz está en 0): la pila de recorrido
+  // tiene 64 entradas
+  static constexpr int MAX_DEPTH = 60;
+
+  const char* name() const override {
+    return "BVH";
+  }
+
+  // Nodos y orden de las hojas de la última construcción, para guardarlos
+  const std::vector<BVHNode>& getNodes() const {
+    return nodes;
+  }
+
+  const std::vector<int>& getPrimitiveIds() const {
+    return primitiveIds;
+  }
+
+  // Adopta un árbol ya construido para `sceneToUse` (p. ej. de la caché de
+  // escena) en vez de construirlo; solo se rearman las cajas de las hojas.
+  // `leafOrder` tiene que ser una permutación de los bloques de la escena.
+  void restore(const Scene& sceneToUse, std::vector<BVHNode> builtNodes, std::vector<int> leafOrder) {
+    auto start = std::chrono::steady_clock::now();
+    const BoxSoA& blocks = sceneToUse.blockBoxes();
+    std::vector<bool> seen(blocks.size(), false);
+    bool permutation = static_cast<int>(leafOrder.size()) == blocks.size();
+    for (size_t i = 0; permutation && i < leafOrder.size(); i++) {
+      int id = leafOrder[i];
+      permutation = id >= 0 && id < blocks.size() && !seen[id];
+      if (permutation) {
+        seen[id] = true;
+      }
+    }
+    if (!permutation) {
+      throw std::runtime_error("BVH leaf order does not match the scene blocks");
+    }
+
+    scene = &sceneToUse;
+    nodes = std::move(builtNodes);
+    primitiveIds = std::move(leafOrder);
+    primitiveBounds.resize(blocks.size());
+    for (int i = 0; i < blocks.size(); i++) {
+      primitiveBounds[i] = blocks.box(i);
+    }
+    fillLeafBoxes();
+    stats.nodeCount = static_cast<int>(nodes.size());
+    finishBuild(start);
+  }
+
+protected:
+  int findClosest(Ray& ray, int ignore) const override {
+    int hitIndex = traverse(ray, false, [&](const BVHNode& node, int& index) {
+      leafBoxes.closest(ray, node.leftOrFirst, node.leftOrFirst + node.count, ignore, index);
+    });
+    return hitIndex >= 0 ? leafBoxes.ids[hitIndex] : -1;
+  }
+
+  bool supportsPackets() const override {
+    return true;
+  }
+
+  // Recorrido del paquete completo: un nodo se visita si algún carril activo
+  // lo cruza antes de su impacto actual.
+  void findClosestPacket(const RayPacket& packet, PacketHit& hit) const override {
+    alignas(32) float zBuffer[PACKET_SIZE];
+    int hitIds[PACKET_SIZE];
+    for (int lane = 0; lane < PACKET_SIZE; lane++) {
+      zBuffer[lane] = packet.tMax[lane];
+      hitIds[lane] = std::numeric_limits<int>::max();
+      hit.ids[lane] = -1;
+    }
+    if (leafBoxes.size() == 0) {
+      std::copy(zBuffer, zBuffer + PACKET_SIZE, hit.dist);
+      return;
+    }
+
+    PacketLanes lanes(packet);
+    uint64_t visited = 0;
+
+    int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+      const BVHNode& node = nodes[stack[--stackSize]];
+      visited++;
+      Lanes tNode, nodeDist;
+      int mask = lanes.intersect(node.bounds, tNode, nodeDist) & packet.activeMask();
+      mask &= lanesMask(lanesNotGreater(tNode, lanesLoad(zBuffer)));
+      if (mask == 0) {
+        continue;
+      }
+
+      if (node.count == 0) {
+        stack[stackSize++] = node.leftOrFirst + 1;
+        stack[stackSize++] = node.leftOrFirst;
+        continue;
+      }
+
+      for (int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+        alignas(32) float dist[PACKET_SIZE];
+        Lanes tNear, laneDist;
+        int hitMask = lanes.intersect(leafBoxes.box(i), tNear, laneDist) & mask;
+        lanesStore(dist, laneDist);
+        int id = leafBoxes.ids[i];
+        for (int lane = 0; lane < packet.count; lane++) {
+          if ((hitMask & (1 << lane)) &&
+              (dist[lane] < zBuffer[lane] || (dist[lane] == zBuffer[lane] && id < hitIds[lane]))) {
+            zBuffer[lane] = dist[lane];
+            hitIds[lane] = id;
+            hit.ids[lane] = id;
+          }
+        }
+      }
+    }
+
+    std::copy(zBuffer, zBuffer + PACKET_SIZE, hit.dist);
+    for (int lane = 0; lane < packet.count; lane++) {
+      countRay(visited);
+    }
+  }
+
+  void buildStructure(ThreadPool& pool) override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int n = blocks.size();
+    primitiveIds.resize(n);
+    primitiveBounds.resize(n);
+    for (int i = 0; i < n; i++) {
+      primitiveIds[i] = i;
+      primitiveBounds[i] = blocks.box(i);
+    }
+
+    nodes.assign(std::max(1, 2 * n - 1), BVHNode{});
+    nodesUsed = 1;
+    nodes[0].leftOrFirst = 0;
+    nodes[0].count = n;
+    if (n > 0) {
+      subdivide(0, 0, pool);
+      pool.wait();
+    }
+    nodes.resize(nodesUsed.load());
+
+    fillLeafBoxes();
+    stats.nodeCount = static_cast<int>(nodes.size());
+  }
+
+  int findOccluder(Ray& ray, int ignore) const override {
+    int occluder = traverse(ray, true, [&](const BVHNode& node, int& index) {
+      leafBoxes.occluder(ray, node.leftOrFirst, node.leftOrFirst + node.count, ignore, index);
+    });
+    return occluder >= 0 ? leafBoxes.ids[occluder] : -1;
+  }
+
+  size_t memoryBytes() const override {
+    return nodes.capacity() * sizeof(BVHNode) + primitiveIds.capacity() * sizeof(int) +
+           primitiveBounds.capacity() * sizeof(AABB) + leafBoxes.bytes();
+  }
+
+private:
+  static constexpr int BINS = 16;
+  static constexpr int PARALLEL_THRESHOLD = 4096;
+
+  // Recorrido de adelante hacia atrás compartido por el impacto más cercano y
+  // el oclusor más cercano: testLeaf(hoja, índice) prueba las cajas de una hoja
+  // achicando ray.tMax. Con `open` el intervalo es (tMin, tMax) y se descartan
+  // también los nodos que empiezan justo en tMax. Devuelve el índice en
+  // leafBoxes del ganador, o -1.
+  template <typename TestLeaf>
+  int traverse(Ray& ray, bool open, TestLeaf testLeaf) const {
+    if (leafBoxes.size() == 0) {
+      return -1;
+    }
+
+    int hitIndex = -1;
+    uint64_t visited = 0;
+    auto reaches = [&](const AABB& bounds, float& tNode) {
+      return bounds.intersect(ray, tNode) && (open ? tNode < ray.tMax : tNode <= ray.tMax);
+    };
+
+    int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+      const BVHNode& node = nodes[stack[--stackSize]];
+      visited++;
+      float tNode;
+      if (!reaches(node.bounds, tNode)) {
+        continue;
+      }
+
+      if (node.count > 0) {
+        testLeaf(node, hitIndex);
+        continue;
+      }
+
+      // Se visita primero el hijo más cercano
+      int near = node.leftOrFirst;
+      int far = node.leftOrFirst + 1;
+      float tLeft, tRight;
+      bool hitLeft = reaches(nodes[near].bounds, tLeft);
+      bool hitRight = reaches(nodes[far].bounds, tRight);
+      if (hitLeft && hitRight && tRight < tLeft) {
+        std::swap(near, far);
+      }
+      if (hitLeft && hitRight) {
+        stack[stackSize++] = far;
+        stack[stackSize++] = near;
+      } else if (hitLeft || hitRight) {
+        stack[stackSize++] = hitLeft ? node.leftOrFirst : node.leftOrFirst + 1;
+      }
+    }
+
+    countRay(visited);
+    return hitIndex;
+  }
+
+  // Copia de las cajas en el orden de las hojas, para probarlas en tandas
+  void fillLeafBoxes() {
+    leafBoxes.clear();
+    leafBoxes.reserve(static_cast<int>(primitiveIds.size()));
+    for (int id : primitiveIds) {
+      leafBoxes.push(primitiveBounds[id], id);
+    }
+  }
+
+  void subdivide(int nodeIndex, int depth, ThreadPool& pool) {
+    BVHNode& node = nodes[nodeIndex];
+    int first = node.leftOrFirst;
+    int count = node.count;
+
+    AABB bounds, centroidBounds;
+    for (int i = first; i < first + count; i++) {
+      const AABB& b = primitiveBounds[primitiveIds[i]];
+      bounds.expand(b);
+      centroidBounds.expand(b.centroid());
+    }
+    node.bounds = bounds;
+    if (count <= 2 || depth >= MAX_DEPTH) {
+      return;
+    }
+
+    // Busca el mejor corte por SAH entre BINS intervalos en cada eje
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; axis++) {
+      float lo = centroidBounds.min[axis];
+      float hi = centroidBounds.max[axis];
+      if (hi - lo <= 0.0f) {
+        continue;
+      }
+
+      AABB binBounds[BINS];
+      int binCount[BINS] = {};
+      float scale = BINS / (hi - lo);
+      for (int i = first; i < first + count; i++) {
+        const AABB& b = primitiveBounds[primitiveIds[i]];
+        int bin = std::min(BINS - 1, static_cast<int>((b.centroid()[axis] - lo) * scale));
+        binCount[bin]++;
+        binBounds[bin].expand(b);
+      }
+
+      float leftArea[BINS - 1];
+      int leftCount[BINS - 1];
+      AABB leftBox;
+      int leftSum = 0;
+      for (int i = 0; i < BINS - 1; i++) {
+        leftSum += binCount[i];
+        leftBox.expand(binBounds[i]);
+        leftCount[i] = leftSum;
+        leftArea[i] = leftBox.surfaceArea();
+      }
+      AABB rightBox;
+      int rightSum = 0;
+      for (int i = BINS - 1; i > 0; i--) {
+        rightSum += binCount[i];
+        rightBox.expand(binBounds[i]);
+        if (leftCount[i - 1] == 0 || rightSum == 0) {
+          continue;
+        }
+        float cost = leftCount[i - 1] * leftArea[i - 1] + rightSum * rightBox.surfaceArea();
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestSplit = i;
+        }
+      }
+    }
+
+    float leafCost = count * bounds.surfaceArea();
+    if (bestAxis < 0 || bestCost >= leafCost) {
+      return;
+    }
+
+    // Particiona los primitivos según el bin del centroide
+    float lo = centroidBounds.min[bestAxis];
+    float scale = BINS / (centroidBounds.max[bestAxis] - lo);
+    auto middle = std::partition(primitiveIds.begin() + first, primitiveIds.begin() + first + count, [&](int id) {
+      int bin = std::min(BINS - 1, static_cast<int>((primitiveBounds[id].centroid()[bestAxis] - lo) * scale));
+      return bin < bestSplit;
+    });
+    int leftCount = static_cast<int>(middle - primitiveIds.begin()) - first;
+
+    int left = nodesUsed.fetch_add(2);
+    nodes[left].leftOrFirst = first;
+    nodes[left].count = leftCount;
+    nodes[left + 1].leftOrFirst = first + leftCount;
+    nodes[left + 1].count = count - leftCount;
+    node.leftOrFirst = left;
+    node.count = 0;
+
+    // Los subárboles grandes se construyen en paralelo; el llamador hace pool.wait()
+    if (count >= PARALLEL_THRESHOLD) {
+      pool.submit([this, left, depth, &pool] { subdivide(left, depth + 1, pool); });
+    } else {
+      subdivide(left, depth + 1, pool);
+    }
+    subdivide(left + 1, depth + 1, pool);
+  }
+
+  std::vector<BVHNode> nodes;
+  std::atomic<int> nodesUsed{0};
+  std::vector<int> primitiveIds;     // ids de bloque en el orden de las hojas
+  std::vector<AABB> primitiveBounds; // indexado por id de bloque
+  BoxSoA leafBoxes;
+};
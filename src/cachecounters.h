@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Fallos y accesos de caché del último nivel contados por el procesador
+// (perf_event en Linux). Cuentan el hilo que los crea y los hilos que este cree
+// después, así que hay que crearlos antes que los pools de hilos. Sin soporte
+// (otro sistema, máquina virtual sin contadores, permisos) available() es false.
+class CacheCounters {
+public:
+  struct Reading {
+    uint64_t misses = 0;
+    uint64_t references = 0;
+  };
+
+  CacheCounters() {
+#ifdef __linux__
+    misses = open(PERF_COUNT_HW_CACHE_MISSES);
+    references = open(PERF_COUNT_HW_CACHE_REFERENCES);
+#endif
+  }
+
+  ~CacheCounters() {
+#ifdef __linux__
+    if (misses >= 0) {
+      close(misses);
+    }
+    if (references >= 0) {
+      close(references);
+    }
+#endif
+  }
+
+  CacheCounters(const CacheCounters&) = delete;
+  CacheCounters& operator=(const CacheCounters&) = delete;
+
+  bool available() const {
+    return misses >= 0 && references >= 0;
+  }
+
+  // Totales desde la creación; la diferencia entre dos lecturas da un intervalo
+  Reading read() const {
+    Reading reading;
+#ifdef __linux__
+    if (available()) {
+      reading.misses = value(misses);
+      reading.references = value(references);
+    }
+#endif
+    return reading;
+  }
+
+private:
+#ifdef __linux__
+  static int open(uint64_t config) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = config;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+  }
+
+  static uint64_t value(int descriptor) {
+    uint64_t count = 0;
+    return ::read(descriptor, &count, sizeof(count)) == sizeof(count) ? count : 0;
+  }
+#endif
+
+  int misses = -1;
+  int references = -1;
+};
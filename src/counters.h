@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "globals.h"
+
+// Con SR1_STATS=0 los SR1_COUNT desaparecen del camino caliente y los totales
+// quedan en cero; los tiempos por etapa se siguen midiendo.
+#ifndef SR1_STATS
+#define SR1_STATS 1
+#endif
+
+// Contadores del camino caliente: rayos por tipo, pruebas de intersección,
+// lecturas de textura y profundidad de recursión de cada rayo sombreado. Cada
+// hilo suma en su propio bloque, sin contención; collect() junta los de todos.
+class Counters {
+public:
+  enum Id {
+    PRIMARY_RAYS,
+    SHADOW_RAYS,
+    REFLECT_RAYS,
+    REFRACT_RAYS,
+    SKYBOX_RAYS,         // rayos que no tocan nada y toman el color del cielo
+    INTERSECTION_TESTS,  // nodos, celdas y primitivos probados por los aceleradores
+    TEXTURE_FETCHES,
+    DEPTH_0,             // histograma: rayos sombreados con recursión 0..MAX_RECURSION
+    COUNT = DEPTH_0 + MAX_RECURSION + 1
+  };
+
+  struct Totals {
+    uint64_t values[COUNT] = {};
+
+    uint64_t operator[](int id) const {
+      return values[id];
+    }
+
+    uint64_t rays() const {
+      return values[PRIMARY_RAYS] + values[SHADOW_RAYS] + values[REFLECT_RAYS] + values[REFRACT_RAYS];
+    }
+  };
+
+  static constexpr bool enabled = SR1_STATS != 0;
+
+  static void add(int id, uint64_t amount) {
+    Block& block = localBlock();
+    block.values[id].store(block.values[id].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  // Suma de todos los hilos desde la última llamada
+  static Totals collect() {
+    Totals totals;
+    std::lock_guard<std::mutex> lock(blocksMutex);
+    for (Block& block : blocks) {
+      for (int i = 0; i < COUNT; i++) {
+        uint64_t value = block.values[i].load(std::memory_order_relaxed);
+        totals.values[i] += value - block.reported[i];
+        block.reported[i] = value;
+      }
+    }
+    return totals;
+  }
+
+private:
+  // Un bloque por hilo en sus propias líneas de caché; solo su hilo escribe
+  struct alignas(64) Block {
+    std::atomic<uint64_t> values[COUNT] = {};
+    uint64_t reported[COUNT] = {};
+  };
+
+  static Block& localBlock() {
+    thread_local Block* block = nullptr;
+    if (!block) {
+      std::lock_guard<std::mutex> lock(blocksMutex);
+      block = &blocks.emplace_back();
+    }
+    return *block;
+  }
+
+  inline static std::mutex blocksMutex;
+  inline static std::deque<Block> blocks;
+};
+
+#if SR1_STATS
+#define SR1_COUNT(id, amount) Counters::add(Counters::id, (amount))
+#else
+#define SR1_COUNT(id, amount) ((void)0)
+#endif
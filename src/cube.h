@@ -2,63 +2,75 @@
 #include <glm/glm.hpp>
 #include "intersect.h"
 #include "object.h"
-#include <string>
 #include "./imageloader.h"
-
+#include "aabb.h"
+#include "block.h"
+#include "ray.h"
+#include "radiance.h"
+#include "raybox.h"
 
 class Cube : public Object {
 public:
-  Cube(const glm::vec3& minBound, const glm::vec3& maxBound, const Material& mat)
-    : minBound(glm::min(minBound, maxBound)), maxBound(glm::max(minBound, maxBound)), Object(mat) {}
-
-  Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const override {
-
-    glm::vec3 invRayDir = 1.0f / rayDirection;
-
-    glm::vec3 t1 = (minBound - rayOrigin) * invRayDir;
-    glm::vec3 t2 = (maxBound - rayOrigin) * invRayDir;
-
-    glm::vec3 tmin = glm::min(t1, t2);
-    glm::vec3 tmax = glm::max(t1, t2);
+  Cube(const glm::vec3& minBound, const glm::vec3& maxBound, const Material& mat, const FaceTextures& textures = FaceTextures{})
+    : minBound(glm::min(minBound, maxBound)), maxBound(glm::max(minBound, maxBound)), Object(mat), textures(textures) {}
 
-    float tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
-    float tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
-
-    if (tNear > tFar || tFar < 0) {
+  Intersect rayIntersect(const Ray& ray) const override {
+    BoxHit hit;
+    if (!rayBox(minBound, maxBound, ray, hit)) {
       return Intersect{false};
     }
-
-    float dist = (tNear < 0) ? tFar : tNear;
-
-    glm::vec3 point = rayOrigin + dist * rayDirection;
-
-    // Calcula la normal basada en el lado del cubo
-    const float epsilon = 0.0001;
-    glm::vec3 normal(0.0f);
-    if (glm::abs(point.x - minBound.x) < epsilon) normal.x = -1.0f;
-    else if (glm::abs(point.x - maxBound.x) < epsilon) normal.x = 1.0f;
-    else if (glm::abs(point.y - minBound.y) < epsilon) normal.y = -1.0f;
-    else if (glm::abs(point.y - maxBound.y) < epsilon) normal.y = 1.0f;
-    else if (glm::abs(point.z - minBound.z) < epsilon) normal.z = -1.0f;
-    else if (glm::abs(point.z - maxBound.z) < epsilon) normal.z = 1.0f;
-
-    return Intersect{true, dist, point, glm::normalize(normal), false};
+    return surface(minBound, maxBound, textures, ray.at(hit.dist), hit.dist, hit.face);
   };
 
-  Color loadTexture(float x, float y, const std::string texturekey) const{
-
-    glm::vec2 tsize = ImageLoader::getImageSize(texturekey);
-
-
-        int tx = static_cast<int>(std::fmod(x * tsize.x, tsize.x));
-        int ty = static_cast<int>(std::fmod(y * tsize.y, tsize.y));
-
-        Color c = ImageLoader::getPixelColor(texturekey, tx, ty);
+  // Texturas de las caras; un cubo sin texturas usa el color del material
+  const FaceTextures& faceTextures() const {
+    return textures;
+  }
+
+  // Paso de sombreado, solo para el impacto ganador: normal de la cara y color
+  // de su textura (`top` arriba, `side` en los lados, `bottom` abajo). Las
+  // caras sin textura quedan con el color del material.
+  static Intersect surface(const glm::vec3& minBound, const glm::vec3& maxBound, const FaceTextures& textures,
+                           const glm::vec3& point, float dist, int face) {
+    Intersect intersect{true, dist, point, faceNormal(face), false};
+
+    TextureHandle texture = textures.side;
+    if (face == FACE_MAX_Y) {
+      texture = textures.top;
+    } else if (face == FACE_MIN_Y) {
+      texture = textures.bottom;
+    }
 
-        return c;
+    if (face != FACE_NONE && texture != NO_TEXTURE) {
+        glm::vec2 uv = faceUV(minBound, maxBound, point, face);
+        intersect.color = loadTexture(uv.x, uv.y, texture);
+        intersect.hasColor = true;
+    }
+    return intersect;
+  }
+
+  AABB bounds() const override {
+    return AABB{minBound, maxBound};
+  }
+
+  // Solo el slab test: las sombras no necesitan normal ni textura
+  bool occluded(const Ray& ray, float& hitDist) const override {
+    float tNear, tFar, dist;
+    if (!bounds().intersect(ray, tNear, tFar) || !clipToRay(ray, tNear, tFar, dist)) {
+      return false;
+    }
+    if (dist > ray.tMin && dist < ray.tMax) {
+      hitDist = dist;
+      return true;
+    }
+    return false;
+  }
 
+  static Radiance loadTexture(float x, float y, TextureHandle texture) {
+    return toRadiance(ImageLoader::texture(texture).sample(x, y));
   };
 
   glm::vec3 minBound;
   glm::vec3 maxBound;
+  FaceTextures textures;
 };
@@ -0,0 +1,193 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include "block.h"
+#include "imageloader.h"
+#include "material.h"
+#include "radiance.h"
+#include "scene.h"
+
+// Texturas de la diorama: clave, archivo (relativo a bin/) y tamaño con el que
+// se escalan las coordenadas. Las cargan los frontends antes de setUp().
+struct TextureEntry {
+    const char* key;
+    const char* path;
+    float width;
+    float height;
+};
+
+inline const TextureEntry DIORAMA_TEXTURES[] = {
+    {"grass", "../assets/grass.png", 800.0f, 800.0f},
+    {"grass_side", "../assets/grass_side.png", 800.0f, 800.0f},
+    {"plank", "../assets/oak_plank.png", 358.0f, 358.0f},
+    {"oak_side", "../assets/oak_side.png", 320.0f, 318.0f},
+    {"leaf", "../assets/leaf.png", 500.0f, 500.0f},
+    {"diamond", "../assets/diamond_ore.png", 256.0f, 256.0f},
+    {"skybox1", "../assets/skybox_1.png", 793.0f, 877.0f},
+    {"skybox2", "../assets/skybox_2.png", 795.0f, 877.0f},
+    {"skybox3", "../assets/skybox_3.png", 792.0f, 877.0f},
+    {"skybox4", "../assets/skybox_4.png", 792.0f, 877.0f},
+    {"skybox_ground", "../assets/skyboxground.png", 322.0f, 282.0f},
+    {"skybox_sky", "../assets/skybox_sky.png", 1080.0f, 1080.0f},
+};
+
+// Tipos de bloque de la diorama (pasto, tronco, hojas, diamante, tablas); las
+// texturas ya tienen que estar cargadas
+inline void addBlockTypes(Scene& scene) {
+    // Define materials
+    Material grass = {
+            Radiance(0.0f),
+            0.85,
+            0.0,
+            0.50f,
+            0.0f,
+            0.0f
+    };
+    Material wood = {
+            Radiance(0.0f),
+            0.85,
+            0.0,
+            0.50f,
+            0.0f,
+            0.0f
+    };
+
+    Material leaf = {
+            Radiance(0.0f),
+            0.85,
+            0.0,
+            0.50f,
+            0.0f,
+            0.0f
+    };
+
+    Material diamond = {
+            Radiance(0.0f),
+            0.85,
+            0.4,
+            2.50f,
+            0.0f,
+            0.0f
+    };
+
+    // Tipos de bloque: textura de arriba, de los lados y de abajo (nullptr: color del material)
+    struct BlockTypeEntry {
+        const char* name;
+        const char* top;
+        const char* side;
+        const char* bottom;
+        Material material;
+    };
+    const BlockTypeEntry blockTypeTable[] = {
+        {"grass", "grass", "grass_side", nullptr, grass},
+        {"oak", "oak_side", "oak_side", nullptr, wood},
+        {"leaf", "leaf", "leaf", nullptr, leaf},
+        {"diamond", "diamond", "diamond", nullptr, diamond},
+        {"plank", "plank", "plank", nullptr, wood},
+    };
+    auto texture = [](const char* key) {
+        return key ? ImageLoader::getHandle(key) : NO_TEXTURE;
+    };
+    for (const BlockTypeEntry& entry : blockTypeTable) {
+        scene.addBlockType(BlockType{entry.name, FaceTextures{texture(entry.top), texture(entry.side), texture(entry.bottom)}, entry.material});
+    }
+}
+
+// Arma la diorama en `scene`
+inline void setUp(Scene& scene) {
+    addBlockTypes(scene);
+    const BlockId grassBlock = scene.findBlockType("grass");
+    const BlockId oakBlock = scene.findBlockType("oak");
+    const BlockId leafBlock = scene.findBlockType("leaf");
+    const BlockId diamondBlock = scene.findBlockType("diamond");
+    const BlockId plankBlock = scene.findBlockType("plank");
+
+    // Scene
+    // Grass floor
+    scene.addBlock(glm::vec3(-3.0f, -0.5f, -5.0f), glm::vec3(10.0f, 0.5f, 5.0f), grassBlock);
+
+    // Tree
+    // Wood
+    scene.addBlock(glm::vec3(-2.0f, 0.5f, -2.0f), glm::vec3(-1.0f, 3.5f, -1.0f), oakBlock);
+    // Leaves
+    scene.addBlock(glm::vec3(-3.0f, 3.5f, -3.0f), glm::vec3(0.0f, 4.5f, 0.0f), leafBlock);
+    scene.addBlock(glm::vec3(-2.0f, 4.5f, -2.0f), glm::vec3(-1.0f, 5.5f, -1.0f), leafBlock);
+
+    // Diamond
+    scene.addBlock(glm::vec3(-2.0f, 0.5f, 2.0f), glm::vec3(1.0f, 1.5f, 1.0f), diamondBlock);
+    scene.addBlock(glm::vec3(-1.0f, 1.5f, 2.0f), glm::vec3(0.0f, 2.5f, 1.0f), diamondBlock);
+    scene.addBlock(glm::vec3(-1.0f, 0.5f, 2.0f), glm::vec3(0.0f, 1.5f, 3.0f), diamondBlock);
+
+    // House
+    // Pared atras
+    scene.addBlock(glm::vec3(3.0f, 0.5f, -4.0f), glm::vec3(7.0f, 4.5f, -3.0f), plankBlock);
+    // Techo 1
+    scene.addBlock(glm::vec3(2.0f, 3.5f, -3.0f), glm::vec3(8.0f, 4.5f, 0.0f), plankBlock);
+    // Techo 2
+    scene.addBlock(glm::vec3(3.0f, 3.5f, 0.0f), glm::vec3(7.0f, 4.5f, 1.0f), plankBlock);
+    // Pared lateral 1
+    scene.addBlock(glm::vec3(2.0f, 0.5f, -3.0f), glm::vec3(3.0f, 3.5f, 0.0f), plankBlock);
+    // Pared lateral 2
+    scene.addBlock(glm::vec3(7.0f, 0.5f, -3.0f), glm::vec3(8.0f, 3.5f, 0.0f), plankBlock);
+    // Columna 1
+    scene.addBlock(glm::vec3(2.0f, 0.5f, 0.0f), glm::vec3(3.0f, 4.5f, 1.0f), oakBlock);
+    // Columna 2
+    scene.addBlock(glm::vec3(7.0f, 0.5f, 0.0f), glm::vec3(8.0f, 4.5f, 1.0f), oakBlock);
+    // Columna 3
+    scene.addBlock(glm::vec3(2.0f, 0.5f, -4.0f), glm::vec3(3.0f, 4.5f, -3.0f), oakBlock);
+    // Columna 4
+    scene.addBlock(glm::vec3(7.0f, 0.5f, -4.0f), glm::vec3(8.0f, 4.5f, -3.0f), oakBlock);
+    // Pared frontal
+    scene.addBlock(glm::vec3(3.0f, 0.5f, 0.0f), glm::vec3(5.0f, 3.5f, 1.0f), plankBlock);
+    // Puerta
+    scene.addBlock(glm::vec3(6.0f, 0.5f, 0.0f), glm::vec3(7.0f, 3.5f, 1.0f), plankBlock);
+
+}
+
+// Terreno generado de size x size columnas de pasto con alturas de 1 a 4,
+// árboles y bloques de diamante dispersos, centrado en el origen. Siempre el
+// mismo para la misma semilla. Cada bloque se entrega a addBlock(min, max, tipo),
+// así sirve tanto para armar una Scene como para un archivo de escena.
+template <typename AddBlock>
+void addTerrain(int size, std::uint32_t seed, BlockId grassBlock, BlockId oakBlock, BlockId leafBlock, BlockId diamondBlock,
+                AddBlock addBlock) {
+    // Generador congruencial: no depende de la implementación de <random>
+    std::uint32_t state = seed;
+    auto next = [&state](std::uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    };
+
+    const float half = size * 0.5f;
+    for (int z = 0; z < size; z++) {
+        for (int x = 0; x < size; x++) {
+            float height = 1.0f + next(4);
+            glm::vec3 base(x - half, -0.5f, z - half);
+            addBlock(base, base + glm::vec3(1.0f, height + 0.5f, 1.0f), grassBlock);
+
+            glm::vec3 top(x - half, height, z - half);
+            switch (next(40)) {
+                case 0:
+                    // Árbol: tronco de 3 y copa de 3x1x3
+                    addBlock(top, top + glm::vec3(1.0f, 3.0f, 1.0f), oakBlock);
+                    addBlock(top + glm::vec3(-1.0f, 3.0f, -1.0f), top + glm::vec3(2.0f, 4.0f, 2.0f), leafBlock);
+                    break;
+                case 1:
+                    addBlock(top, top + glm::vec3(1.0f), diamondBlock);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+// Terreno generado con los tipos de bloque de la diorama; sirve para medir con
+// escenas más grandes que la diorama
+inline void generateTerrain(Scene& scene, int size, std::uint32_t seed) {
+    addBlockTypes(scene);
+    addTerrain(size, seed, scene.findBlockType("grass"), scene.findBlockType("oak"), scene.findBlockType("leaf"),
+               scene.findBlockType("diamond"), [&scene](const glm::vec3& minBound, const glm::vec3& maxBound, BlockId type) {
+                   scene.addBlock(minBound, maxBound, type);
+               });
+}
@@ -1,23 +0,0 @@
-#include <SDL.h>
-#include <iostream>
-#include <sstream>
-
-uint32_t frameStart, frameTick;
-
-void startFPS()
-{
-    frameStart, frameTick = 0;
-    frameStart = SDL_GetTicks();
-}
-
-void endFPS(SDL_Window *window)
-{
-    frameTick = SDL_GetTicks() - frameStart;
-
-    if (frameTick > 0)
-    {
-        std::ostringstream titleStream;
-        titleStream << "Proyecto 3: Raytracing - FPS: " << 1000.0 / frameTick;
-        SDL_SetWindowTitle(window, titleStream.str().c_str());
-    }
-}
\ No newline at end of file
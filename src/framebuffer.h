@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include "color.h"
+#include "radiance.h"
+
+static_assert(sizeof(Color) == 4, "Color debe ser RGBA8 empaquetado");
+
+// Imagen en memoria (RGBA8, fila por fila) donde escribe render().
+// Su layout coincide con SDL_PIXELFORMAT_RGBA32, así que se sube tal cual.
+struct Framebuffer {
+  int width;
+  int height;
+  std::vector<Color> pixels;
+
+  Framebuffer(int width, int height)
+    : width(width), height(height), pixels(width * height) {}
+
+  Color& at(int x, int y) {
+    return pixels[y * width + x];
+  }
+
+  const Color& at(int x, int y) const {
+    return pixels[y * width + x];
+  }
+
+  int pitch() const {
+    return width * static_cast<int>(sizeof(Color));
+  }
+};
+
+static_assert(sizeof(Radiance) == 3 * sizeof(float), "Radiance debe ser RGB float empaquetado");
+
+// Radiancia lineal de cada píxel antes del tonemap. Los canales quedan
+// seguidos (r, g, b, r, g, b, ...), así que una fila se recorre como floats.
+struct HdrFramebuffer {
+  int width;
+  int height;
+  std::vector<Radiance> pixels;
+
+  HdrFramebuffer(int width, int height)
+    : width(width), height(height), pixels(width * height) {}
+
+  Radiance& at(int x, int y) {
+    return pixels[y * width + x];
+  }
+
+  const Radiance& at(int x, int y) const {
+    return pixels[y * width + x];
+  }
+
+  const float* row(int y) const {
+    return &pixels[y * width].x;
+  }
+};
@@ -6,3 +6,5 @@ const float RATIO = static_cast<float>(WIDTH) / static_cast<float>(HEIGHT);
 
 const int MAX_RECURSION = 3;
 const float BIAS = 0.0001f;
+
+const int TILE_SIZE = 16;
@@ -0,0 +1,187 @@
+#include "headless.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "assets.h"
+#include "camera.h"
+#include "framebuffer.h"
+#include "globals.h"
+#include "imageloader.h"
+#include "imagewriter.h"
+#include "options.h"
+#include "renderer.h"
+#include "scenefile.h"
+#include "timeline.h"
+
+namespace {
+
+// "a,b,c" o "a,b,c,d,e,f"; devuelve cuántos números leyó
+int parseFloats(const std::string& text, float* values, int maxCount) {
+    int count = 0;
+    const char* cursor = text.c_str();
+    while (count < maxCount && *cursor) {
+        char* end;
+        values[count] = std::strtof(cursor, &end);
+        if (end == cursor) {
+            break;
+        }
+        count++;
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+// Ruta del cuadro `frame`: con un solo cuadro se usa tal cual, si no se le
+// agrega el número antes de la extensión (frame.png -> frame_0003.png)
+std::string framePath(const std::string& path, int frame, int frameCount) {
+    if (frameCount == 1) {
+        return path;
+    }
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%04d", frame);
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+} // namespace
+
+int runHeadless(int argc, char* argv[]) {
+    StartupTimeline::start();
+    int width = WIDTH;
+    int height = HEIGHT;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--size" && std::sscanf(argv[i + 1], "%dx%d", &width, &height) != 2) {
+            std::cerr << "Error: --size espera ANCHOxALTO, p. ej. 1920x1080" << std::endl;
+            return 1;
+        }
+    }
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Error: tamaño inválido " << width << "x" << height << std::endl;
+        return 1;
+    }
+
+    Renderer renderer(width, height);
+    // Un render fuera de línea no reutiliza cuadros ni muestra vista previa:
+    // cada imagen se traza entera hasta converger
+    renderer.reprojection.setEnabled(false);
+    renderer.progressive.setPreviewScale(1);
+
+    Camera camera(glm::vec3(-3.0f, 2.0f, 10.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
+    unsigned threads = 0;
+    std::string scenePath;
+    std::string packPath;
+    bool cameraGiven = false;
+    int frameCount = 1;
+    float orbitDegrees = 0.0f;
+    std::string output = "frame.png";
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--headless") {
+            continue;
+        } else if (option == "--size" && hasValue) {
+            i++;
+        } else if (option == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (option == "--camera" && hasValue) {
+            float values[6];
+            int count = parseFloats(argv[++i], values, 6);
+            if (count != 3 && count != 6) {
+                std::cerr << "Error: --camera espera x,y,z o x,y,z,objetivoX,objetivoY,objetivoZ" << std::endl;
+                return 1;
+            }
+            camera.position = glm::vec3(values[0], values[1], values[2]);
+            if (count == 6) {
+                camera.target = glm::vec3(values[3], values[4], values[5]);
+            }
+            cameraGiven = true;
+        } else if (option == "--scene" && hasValue) {
+            scenePath = argv[++i];
+        } else if (option == "--pack" && hasValue) {
+            packPath = argv[++i];
+        } else if (option == "--frames" && hasValue) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--orbit" && hasValue) {
+            orbitDegrees = static_cast<float>(std::atof(argv[++i]));
+        } else if (option == "--out" && hasValue) {
+            output = argv[++i];
+        } else if (!parseRenderOption(renderer, argc, argv, i)) {
+            std::cerr << "Aviso: opción ignorada en modo sin pantalla: " << option << std::endl;
+        }
+    }
+
+    Framebuffer image(width, height);
+    try {
+        SceneDocument sceneFile;
+        if (!packPath.empty()) {
+            loadPack(packPath, std::cout);
+        }
+        if (scenePath.empty()) {
+            loadAssets(threads);
+            StartupTimeline::Scope timing("armar la escena");
+            setUp(renderer.scene);
+        } else {
+            {
+                StartupTimeline::Scope timing("abrir " + scenePath);
+                sceneFile = SceneFile::open(scenePath);
+            }
+            loadAssets(sceneFile, threads);
+            StartupTimeline::Scope timing("armar la escena");
+            sceneFile.apply(renderer);
+            if (sceneFile.hasCamera && !cameraGiven) {
+                camera.position = sceneFile.cameraPosition;
+                camera.target = sceneFile.cameraTarget;
+            }
+        }
+        ImageLoader::freeze();
+        renderer.start(threads);
+        renderer.reportBuild(std::cout);
+        if (!scenePath.empty()) {
+            SceneFile::updateCache(sceneFile, renderer, std::cout);
+        }
+
+        for (int frame = 0; frame < frameCount; frame++) {
+            auto start = std::chrono::steady_clock::now();
+            int passes = 0;
+            // Con el progresivo, pasadas hasta llegar a --samples; sin él, un solo cuadro completo
+            do {
+                renderer.beginFrame(camera, image);
+                if (!renderer.endFrame()) {
+                    break;
+                }
+                passes++;
+            } while (renderer.currentPass().mode == ProgressivePass::Refine && !renderer.converged());
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            if (frame == 0) {
+                StartupTimeline::record("primer cuadro", start, end);
+                StartupTimeline::report(std::cout, "Arranque");
+            }
+
+            std::string path = framePath(output, frame, frameCount);
+            ImageWriter::write(path, image, renderer.radiance());
+            std::cout << "Cuadro " << frame << ": " << ms << " ms, " << passes << " pasadas -> " << path << std::endl;
+
+            // Giro alrededor del objetivo en el eje vertical, para el cuadro siguiente
+            glm::quat orbit = glm::angleAxis(glm::radians(orbitDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+            camera.position = camera.target + orbit * (camera.position - camera.target);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    renderer.report(std::cout);
+    ImageFile::quit();
+    return 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Render sin ventana: carga la escena, traza los cuadros pedidos en memoria y
+// los escribe a disco (PNG, PPM o EXR). No inicializa el video de SDL ni abre
+// un bucle de eventos, así que corre en máquinas sin pantalla.
+int runHeadless(int argc, char* argv[]);
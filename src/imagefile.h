@@ -0,0 +1,85 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL_image.h>
+#include <stdexcept>
+#include <string>
+#include "imageloader.h"
+
+// Lectura de imágenes con SDL_image. Solo usa superficies en memoria: no
+// inicializa el video de SDL, así que sirve también sin pantalla.
+class ImageFile {
+public:
+    // Initialize SDL_image
+    static void init() {
+        int imgFlags = IMG_INIT_PNG; // or IMG_INIT_JPG, depending on your needs
+        if (!(IMG_Init(imgFlags) & imgFlags)) {
+            throw std::runtime_error("SDL_image could not initialize! SDL_image Error: " + std::string(IMG_GetError()));
+        }
+    }
+
+    // Load an image from a given path, decode it and store it with a key
+    static TextureHandle load(const std::string& key, const char* path, float xSize, float ySize) {
+        Texture texture = read(path);
+        texture.size = glm::vec2(xSize, ySize);
+        return ImageLoader::addTexture(key, std::move(texture));
+    }
+
+    // Lee y decodifica sin registrar; se puede llamar desde varios hilos a la
+    // vez después de init()
+    static Texture read(const std::string& path) {
+        SDL_Surface *newSurface = IMG_Load(path.c_str());
+        if (!newSurface) {
+            throw std::runtime_error("Unable to load image " + path + "! SDL_image Error: " + std::string(IMG_GetError()));
+        }
+        Texture texture = decode(newSurface);
+        SDL_FreeSurface(newSurface);
+        return texture;
+    }
+
+    static void quit() {
+        IMG_Quit();
+    }
+
+private:
+    // Convierte la superficie a Color una sola vez, con SDL_GetRGB por texel
+    static Texture decode(SDL_Surface* surface) {
+        Texture texture;
+        texture.width = surface->w;
+        texture.height = surface->h;
+        texture.texels.resize(static_cast<size_t>(surface->w) * surface->h);
+
+        int bpp = surface->format->BytesPerPixel;
+        for (int y = 0; y < surface->h; y++) {
+            for (int x = 0; x < surface->w; x++) {
+                Uint8 *p = (Uint8 *)surface->pixels + (surface->h - 1 - y) * surface->pitch + x * bpp;
+
+                Uint32 pixelColor;
+                switch (bpp) {
+                    case 1:
+                        pixelColor = *p;
+                        break;
+                    case 2:
+                        pixelColor = *(Uint16 *)p;
+                        break;
+                    case 3:
+                        if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+                            pixelColor = p[0] << 16 | p[1] << 8 | p[2];
+                        } else {
+                            pixelColor = p[0] | p[1] << 8 | p[2] << 16;
+                        }
+                        break;
+                    case 4:
+                        pixelColor = *(Uint32 *)p;
+                        break;
+                    default:
+                        throw std::runtime_error("Unknown format!");
+                }
+
+                SDL_Color color;
+                SDL_GetRGB(pixelColor, surface->format, &color.r, &color.g, &color.b);
+                texture.texels[static_cast<size_t>(y) * surface->w + x] = Color{color.r, color.g, color.b};
+            }
+        }
+        return texture;
+    }
+};
@@ -1,113 +1,162 @@
 #pragma once
-#include <SDL2/SDL.h>
-#include <SDL_image.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <map>
 #include <string>
+#include <vector>
 #include "color.h"
+#include "counters.h"
 #include <glm/glm.hpp>
 
+// Índice de una textura en ImageLoader; se resuelve una vez al armar la escena
+using TextureHandle = int;
+const TextureHandle NO_TEXTURE = -1;
 
+// Imagen ya decodificada a Color. La fila 0 es la de abajo de la imagen.
+// `size` es el tamaño declarado al cargarla, con el que se escalan las coordenadas.
+// Los texels son propios (`texels`) o se leen sin copiar de un paquete de
+// texturas proyectado en memoria (`mapped`).
+struct Texture {
+    int width = 0;
+    int height = 0;
+    glm::vec2 size;
+    std::vector<Color> texels;
+    const Color* mapped = nullptr;
+
+    const Color* data() const {
+        return mapped ? mapped : texels.data();
+    }
+
+    Color texel(int x, int y) const {
+        x = std::clamp(x, 0, width - 1);
+        y = std::clamp(y, 0, height - 1);
+        return data()[static_cast<size_t>(y) * width + x];
+    }
+
+    // Coordenadas en unidades de la textura completa; se repite fuera de [0, 1)
+    Color sample(float x, float y) const {
+        SR1_COUNT(TEXTURE_FETCHES, 1);
+        int tx = static_cast<int>(std::fmod(x * size.x, size.x));
+        int ty = static_cast<int>(std::fmod(y * size.y, size.y));
+        return texel(tx, ty);
+    }
+};
+
+// Registro de texturas: se cargan al inicio y freeze() las deja inmutables,
+// así que muestrear desde varios hilos no necesita locks. La excepción son las
+// diferidas, que se decodifican una sola vez la primera vez que se piden,
+// desde el hilo que las pida. No sabe leer archivos: eso lo hace ImageFile,
+// para que el núcleo no dependa de SDL.
 class ImageLoader {
 private:
-    static std::map<std::string, SDL_Surface*> imageSurfaces;
-    static std::map<std::string, glm::vec2> imageSize;
-    
-public:
-    // Initialize SDL_image
-    static void init() {
-        int imgFlags = IMG_INIT_PNG; // or IMG_INIT_JPG, depending on your needs
-        if (!(IMG_Init(imgFlags) & imgFlags)) {
-            throw std::runtime_error("SDL_image could not initialize! SDL_image Error: " + std::string(IMG_GetError()));
+    // Decodificación pendiente de una textura diferida
+    struct Deferred {
+        std::function<Texture()> decode;
+        std::atomic<bool> ready{false};
+        std::mutex mutex;
+    };
+
+    inline static std::vector<Texture> textures;
+    inline static std::vector<std::unique_ptr<Deferred>> deferred; // nulo si la textura ya está
+    inline static std::map<std::string, TextureHandle> handles;
+    inline static bool frozen = false;
+
+    static TextureHandle store(const std::string& key, Texture texture, std::unique_ptr<Deferred> pending) {
+        if (frozen) {
+            throw std::runtime_error("ImageLoader is frozen, cannot load " + key);
+        }
+        auto it = handles.find(key);
+        if (it != handles.end()) {
+            textures[it->second] = std::move(texture);
+            deferred[it->second] = std::move(pending);
+            return it->second;
         }
+        textures.push_back(std::move(texture));
+        deferred.push_back(std::move(pending));
+        TextureHandle handle = static_cast<TextureHandle>(textures.size()) - 1;
+        handles[key] = handle;
+        return handle;
     }
 
-    // Load an image from a given path and store with a key
-    static void loadImage(const std::string& key, const char* path, float xSize, float ySize) {
-        SDL_Surface *newSurface = IMG_Load(path);
-        if (!newSurface) {
-            throw std::runtime_error("Unable to load image! SDL_image Error: " + std::string(IMG_GetError()));
+    // Primer pedido de una textura diferida: la decodifica quien llegue primero
+    // y los demás esperan a que termine
+    static void resolve(TextureHandle handle) {
+        Deferred& pending = *deferred[handle];
+        std::lock_guard<std::mutex> lock(pending.mutex);
+        if (!pending.ready.load(std::memory_order_relaxed)) {
+            glm::vec2 size = textures[handle].size;
+            textures[handle] = pending.decode();
+            textures[handle].size = size;
+            pending.ready.store(true, std::memory_order_release);
         }
-        imageSurfaces[key] = newSurface;
-        ImageLoader::imageSize[key] = glm::vec2(xSize, ySize);
     }
 
-    // Get the color of the pixel at (x, y) from an image with a specific key
-    static Color getPixelColor(const std::string& key, int x, int y) {
-        auto it = imageSurfaces.find(key);
-        if (it == imageSurfaces.end()) {
-            throw std::runtime_error("Image key not found!");
-        }
+public:
+    // Guarda la textura ya decodificada con su clave; si la clave existe, la
+    // reemplaza y conserva el handle
+    static TextureHandle addTexture(const std::string& key, Texture texture) {
+        return store(key, std::move(texture), nullptr);
+    }
 
-        SDL_Surface* targetSurface = it->second;
-        int bpp = targetSurface->format->BytesPerPixel;
-        Uint8 *p = (Uint8 *)targetSurface->pixels + (targetSurface->h - 1 - y) * targetSurface->pitch + x * bpp;
-
-        Uint32 pixelColor;
-        switch (bpp) {
-            case 1:
-                pixelColor = *p;
-                break;
-            case 2:
-                pixelColor = *(Uint16 *)p;
-                break;
-            case 3:
-                if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
-                    pixelColor = p[0] << 16 | p[1] << 8 | p[2];
-                } else {
-                    pixelColor = p[0] | p[1] << 8 | p[2] << 16;
-                }
-                break;
-            case 4:
-                pixelColor = *(Uint32 *)p;
-                break;
-            default:
-                throw std::runtime_error("Unknown format!");
-        }
-        
-        SDL_Color color;
-        SDL_GetRGB(pixelColor, targetSurface->format, &color.r, &color.g, &color.b);
-        return Color{color.r, color.g, color.b};
+    // Registra la textura sin decodificarla: `decode` corre recién la primera
+    // vez que se pide con texture(), aunque ya esté congelado el registro
+    static TextureHandle addDeferred(const std::string& key, glm::vec2 size, std::function<Texture()> decode) {
+        auto pending = std::make_unique<Deferred>();
+        pending->decode = std::move(decode);
+        Texture placeholder;
+        placeholder.size = size;
+        return store(key, std::move(placeholder), std::move(pending));
     }
 
-    static glm::vec2 getImageSize(const std::string& key){
-        return imageSize[key];
+    // Si la textura de `key` se lee de un paquete proyectado (AssetPack)
+    static bool isMapped(const std::string& key) {
+        auto it = handles.find(key);
+        return it != handles.end() && textures[it->second].mapped != nullptr;
     }
 
-    static void render(SDL_Renderer* renderer, const std::string& key, int x, int y) {
-        auto it = imageSurfaces.find(key);
-        if (it == imageSurfaces.end()) {
+    // Resolución de clave a handle; no usar en el camino caliente
+    static TextureHandle getHandle(const std::string& key) {
+        auto it = handles.find(key);
+        if (it == handles.end()) {
             throw std::runtime_error("Image key not found!");
         }
+        return it->second;
+    }
 
-        SDL_Surface* targetSurface = it->second;
+    // Después de esto no se cargan más imágenes y las texturas no cambian,
+    // salvo las diferidas al decodificarse
+    static void freeze() {
+        frozen = true;
+    }
 
-        // Convert surface to texture
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, targetSurface);
-        if (!texture) {
-            throw std::runtime_error("Unable to create texture from surface! SDL Error: " + std::string(SDL_GetError()));
+    static const Texture& texture(TextureHandle handle) {
+        const Deferred* pending = deferred[handle].get();
+        if (pending && !pending->ready.load(std::memory_order_acquire)) {
+            resolve(handle);
         }
+        return textures[handle];
+    }
 
-        // Set render destination and render the texture
-        SDL_Rect destRect = { x, y, targetSurface->w, targetSurface->h };
-        SDL_RenderCopy(renderer, texture, NULL, &destRect);
+    // Get the color of the pixel at (x, y) from an image with a specific key
+    static Color getPixelColor(const std::string& key, int x, int y) {
+        return texture(getHandle(key)).texel(x, y);
+    }
 
-        // Free the created texture
-        SDL_DestroyTexture(texture);
+    // El tamaño declarado se conoce sin decodificar las diferidas
+    static glm::vec2 getImageSize(const std::string& key){
+        return textures[getHandle(key)].size;
     }
 
     // Clean up
     static void cleanup() {
-        for (auto& pair : imageSurfaces) {
-            if (pair.second) {
-                SDL_FreeSurface(pair.second);
-            }
-        }
-        imageSurfaces.clear();
-        IMG_Quit();
+        textures.clear();
+        deferred.clear();
+        handles.clear();
+        frozen = false;
     }
 };
-
-std::map<std::string, SDL_Surface*> ImageLoader::imageSurfaces;
-std::map<std::string, glm::vec2> ImageLoader::imageSize;
-
@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "framebuffer.h"
+
+// Escritura de los cuadros a disco sin bibliotecas externas. PNG y PPM guardan
+// la imagen ya pasada por el tonemap; EXR guarda la radiancia lineal en float.
+// El PNG va sin comprimir (bloques "stored" de deflate): más grande, pero no
+// necesita zlib.
+class ImageWriter {
+public:
+  // Elige el formato por la extensión de `path`: .png, .ppm o .exr
+  static void write(const std::string& path, const Framebuffer& image, const HdrFramebuffer& radiance) {
+    if (hasExtension(path, ".exr")) {
+      writeExr(path, radiance);
+    } else if (hasExtension(path, ".ppm")) {
+      writePpm(path, image);
+    } else if (hasExtension(path, ".png")) {
+      writePng(path, image);
+    } else {
+      throw std::runtime_error("Unknown image format: " + path);
+    }
+  }
+
+  static void writePpm(const std::string& path, const Framebuffer& image) {
+    Bytes bytes;
+    std::string header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+    bytes.insert(bytes.end(), header.begin(), header.end());
+    for (const Color& pixel : image.pixels) {
+      bytes.insert(bytes.end(), {pixel.r, pixel.g, pixel.b});
+    }
+    save(path, bytes);
+  }
+
+  static void writePng(const std::string& path, const Framebuffer& image) {
+    // Filas RGB, cada una con su byte de filtro (0: sin filtro)
+    Bytes raw;
+    raw.reserve(static_cast<size_t>(image.height) * (3 * image.width + 1));
+    for (int y = 0; y < image.height; y++) {
+      raw.push_back(0);
+      for (int x = 0; x < image.width; x++) {
+        const Color& pixel = image.at(x, y);
+        raw.insert(raw.end(), {pixel.r, pixel.g, pixel.b});
+      }
+    }
+
+    Bytes zlib = {0x78, 0x01};
+    const size_t BLOCK = 65535;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += BLOCK) {
+      size_t length = std::min(BLOCK, raw.size() - offset);
+      bool last = offset + length >= raw.size();
+      zlib.push_back(last ? 1 : 0);
+      putLittle16(zlib, static_cast<std::uint16_t>(length));
+      putLittle16(zlib, static_cast<std::uint16_t>(~length));
+      zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    putBig32(zlib, adler32(raw));
+
+    Bytes header;
+    putBig32(header, static_cast<std::uint32_t>(image.width));
+    putBig32(header, static_cast<std::uint32_t>(image.height));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits, RGB, deflate, sin filtro adaptativo, sin entrelazado
+
+    Bytes bytes = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    putChunk(bytes, "IHDR", header);
+    putChunk(bytes, "IDAT", zlib);
+    putChunk(bytes, "IEND", Bytes());
+    save(path, bytes);
+  }
+
+  // OpenEXR de líneas sin compresión con canales B, G, R en float de 32 bits
+  static void writeExr(const std::string& path, const HdrFramebuffer& radiance) {
+    Bytes bytes;
+    putLittle32(bytes, 20000630); // número mágico
+    putLittle32(bytes, 2);        // versión 2, imagen de líneas
+
+    Bytes channels;
+    for (const char* name : {"B", "G", "R"}) {
+      putString(channels, name);
+      putLittle32(channels, 2); // FLOAT
+      channels.insert(channels.end(), {0, 0, 0, 0});
+      putLittle32(channels, 1);
+      putLittle32(channels, 1);
+    }
+    channels.push_back(0);
+    putAttribute(bytes, "channels", "chlist", channels);
+    putAttribute(bytes, "compression", "compression", Bytes{0});
+
+    Bytes window;
+    for (int value : {0, 0, radiance.width - 1, radiance.height - 1}) {
+      putLittle32(window, static_cast<std::uint32_t>(value));
+    }
+    putAttribute(bytes, "dataWindow", "box2i", window);
+    putAttribute(bytes, "displayWindow", "box2i", window);
+    putAttribute(bytes, "lineOrder", "lineOrder", Bytes{0});
+    putAttribute(bytes, "pixelAspectRatio", "float", floatBytes({1.0f}));
+    putAttribute(bytes, "screenWindowCenter", "v2f", floatBytes({0.0f, 0.0f}));
+    putAttribute(bytes, "screenWindowWidth", "float", floatBytes({1.0f}));
+    bytes.push_back(0);
+
+    // Tabla de offsets de cada línea y después las líneas
+    const std::uint32_t lineSize = static_cast<std::uint32_t>(3 * sizeof(float) * radiance.width);
+    std::uint64_t offset = bytes.size() + sizeof(std::uint64_t) * radiance.height;
+    for (int y = 0; y < radiance.height; y++) {
+      putLittle64(bytes, offset);
+      offset += 8 + lineSize;
+    }
+    for (int y = 0; y < radiance.height; y++) {
+      putLittle32(bytes, static_cast<std::uint32_t>(y));
+      putLittle32(bytes, lineSize);
+      for (int channel = 2; channel >= 0; channel--) {
+        for (int x = 0; x < radiance.width; x++) {
+          putFloat(bytes, radiance.at(x, y)[channel]);
+        }
+      }
+    }
+    save(path, bytes);
+  }
+
+private:
+  using Bytes = std::vector<std::uint8_t>;
+
+  static bool hasExtension(const std::string& path, const std::string& extension) {
+    if (path.size() < extension.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < extension.size(); i++) {
+      char c = path[path.size() - extension.size() + i];
+      if (std::tolower(static_cast<unsigned char>(c)) != extension[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void save(const std::string& path, const Bytes& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Unable to open " + path + " for writing");
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+      throw std::runtime_error("Unable to write " + path);
+    }
+  }
+
+  static void putLittle16(Bytes& out, std::uint16_t value) {
+    out.insert(out.end(), {static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8)});
+  }
+
+  static void putLittle32(Bytes& out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+  }
+
+  static void putLittle64(Bytes& out, std::uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+      out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+  }
+
+  static void putBig32(Bytes& out, std::uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+  }
+
+  static void putFloat(Bytes& out, float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putLittle32(out, bits);
+  }
+
+  static Bytes floatBytes(std::initializer_list<float> values) {
+    Bytes out;
+    for (float value : values) {
+      putFloat(out, value);
+    }
+    return out;
+  }
+
+  static void putString(Bytes& out, const char* text) {
+    out.insert(out.end(), text, text + std::strlen(text) + 1);
+  }
+
+  static void putAttribute(Bytes& out, const char* name, const char* type, const Bytes& value) {
+    putString(out, name);
+    putString(out, type);
+    putLittle32(out, static_cast<std::uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+  }
+
+  static void putChunk(Bytes& out, const char* type, const Bytes& data) {
+    putBig32(out, static_cast<std::uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBig32(out, crc32(out.data() + start, out.size() - start));
+  }
+
+  static std::uint32_t crc32(const std::uint8_t* data, size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+      std::array<std::uint32_t, 256> result;
+      for (std::uint32_t i = 0; i < 256; i++) {
+        std::uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++) {
+          value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+        }
+        result[i] = value;
+      }
+      return result;
+    }();
+    std::uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++) {
+      crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+  }
+
+  static std::uint32_t adler32(const Bytes& data) {
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (std::uint8_t value : data) {
+      a = (a + value) % 65521;
+      b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+  }
+};
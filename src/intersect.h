@@ -1,14 +1,22 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include "color.h"
+#include "radiance.h"
 
+// Atributos completos de un impacto, para sombrear
 struct Intersect {
   bool isIntersecting = false;
   float dist = 0.0f;
   glm::vec3 point;
   glm::vec3 normal;
   bool hasColor;
-  Color color;
+  Radiance color;
 };
 
+// Resultado del paso geométrico: lo mínimo para elegir el impacto más cercano.
+// Punto, normal y color se calculan después, solo para el ganador (Scene::surface).
+struct Hit {
+  float dist = 99999;
+  int primitive = -1; // -1 si no hay impacto
+  int face = -1;      // BoxFace de los bloques; -1 para otros objetos
+};
@@ -0,0 +1,199 @@
+// sr1_kernel_bench: mide el núcleo rayo/caja solo, sin escena ni render. Cada
+// variante prueba los mismos rayos contra las mismas cajas y escribe en JSON
+// los ns por prueba rayo/caja (mediana de las repeticiones) y los impactos,
+// que tienen que coincidir entre las variantes que prueban todos los pares.
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "aabb.h"
+#include "boxsoa.h"
+#include "ray.h"
+#include "raybox.h"
+#include "raypacket.h"
+
+#ifndef SR1_COMMIT
+#define SR1_COMMIT "unknown"
+#endif
+
+namespace {
+
+struct Options {
+    int boxes = 4096;
+    int rays = 2048;
+    int repetitions = 5;
+    std::string output;
+};
+
+struct Result {
+    const char* name;
+    double nsPerTest;
+    uint64_t hits;
+};
+
+// Bloques de un lado en una región de 32^3 y rayos desde afuera hacia ella;
+// uno de cada ocho con una componente de la dirección en cero
+void makeInputs(const Options& options, std::vector<AABB>& boxes, std::vector<Ray>& rays) {
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> cell(-16, 15);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int i = 0; i < options.boxes; i++) {
+        glm::vec3 min(cell(rng), cell(rng), cell(rng));
+        boxes.push_back(AABB{min, min + glm::vec3(1.0f)});
+    }
+    for (int i = 0; i < options.rays; i++) {
+        glm::vec3 origin = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng))) * 40.0f;
+        glm::vec3 direction = glm::vec3(unit(rng), unit(rng), unit(rng)) * 12.0f - origin;
+        if (i % 8 == 0) {
+            direction[i % 3] = 0.0f;
+        }
+        rays.emplace_back(origin, glm::normalize(direction));
+    }
+}
+
+// Corre `kernel` las veces pedidas y devuelve la mediana en ns por prueba
+double measure(const Options& options, uint64_t tests, const std::function<uint64_t()>& kernel, uint64_t& hits) {
+    std::vector<double> times;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+        auto start = std::chrono::steady_clock::now();
+        hits = kernel();
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        times.push_back(elapsed / static_cast<double>(tests));
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+std::vector<Result> runKernels(const Options& options) {
+    std::vector<AABB> boxes;
+    std::vector<Ray> rays;
+    makeInputs(options, boxes, rays);
+    uint64_t tests = static_cast<uint64_t>(boxes.size()) * rays.size();
+
+    BoxSoA table;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        table.push(boxes[i], static_cast<int>(i));
+    }
+    std::vector<RayPacket> packets;
+    for (size_t i = 0; i < rays.size(); i += PACKET_SIZE) {
+        RayPacket& packet = packets.emplace_back();
+        packet.count = static_cast<int>(std::min<size_t>(PACKET_SIZE, rays.size() - i));
+        for (int lane = 0; lane < PACKET_SIZE; lane++) {
+            const Ray& ray = rays[std::min(i + lane, rays.size() - 1)];
+            packet.set(lane, ray.origin, ray.direction);
+        }
+    }
+
+    std::vector<Result> results;
+    uint64_t hits = 0;
+
+    // Distancia, cara y coordenadas, como los bloques al sombrear
+    double ns = measure(options, tests, [&] {
+        uint64_t count = 0;
+        for (const Ray& ray : rays) {
+            for (const AABB& box : boxes) {
+                BoxHit hit;
+                count += rayBox(box.min, box.max, ray, hit);
+            }
+        }
+        return count;
+    }, hits);
+    results.push_back(Result{"rayBox", ns, hits});
+
+    // Solo la distancia, como los nodos del BVH y las celdas de la grilla
+    ns = measure(options, tests, [&] {
+        uint64_t count = 0;
+        for (const Ray& ray : rays) {
+            for (const AABB& box : boxes) {
+                float tNear, tFar, dist;
+                count += box.intersect(ray, tNear, tFar) && clipToRay(ray, tNear, tFar, dist);
+            }
+        }
+        return count;
+    }, hits);
+    results.push_back(Result{"aabbSlab", ns, hits});
+
+    // Un rayo contra PACKET_SIZE cajas por instrucción; cuenta los rayos con
+    // impacto, no los pares
+    ns = measure(options, tests, [&] {
+        uint64_t count = 0;
+        for (const Ray& ray : rays) {
+            Ray clipped = ray;
+            int index = -1;
+            table.closest(clipped, 0, table.size(), -1, index);
+            count += index >= 0;
+        }
+        return count;
+    }, hits);
+    results.push_back(Result{"boxSoaClosest", ns, hits});
+
+    // PACKET_SIZE rayos contra una caja por instrucción
+    ns = measure(options, tests, [&] {
+        uint64_t count = 0;
+        for (const RayPacket& packet : packets) {
+            PacketLanes lanes(packet);
+            for (const AABB& box : boxes) {
+                Lanes tNear, dist;
+                int mask = lanes.intersect(box, tNear, dist) & packet.activeMask();
+                count += static_cast<uint64_t>(std::popcount(static_cast<unsigned>(mask)));
+            }
+        }
+        return count;
+    }, hits);
+    results.push_back(Result{"packetLanes", ns, hits});
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--boxes" && hasValue) {
+            options.boxes = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--rays" && hasValue) {
+            options.rays = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--reps" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "Aviso: opción ignorada: " << option << std::endl;
+        }
+    }
+
+    std::vector<Result> results = runKernels(options);
+    std::ostringstream json;
+    json << "{\n  \"commit\": \"" << SR1_COMMIT << "\",\n"
+         << "  \"packetSize\": " << PACKET_SIZE << ",\n"
+         << "  \"boxes\": " << options.boxes << ", \"rays\": " << options.rays << ", \"repetitions\": " << options.repetitions << ",\n"
+         << "  \"kernels\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        json << "    {\"name\": \"" << results[i].name << "\", \"nsPerTest\": " << results[i].nsPerTest
+             << ", \"hits\": " << results[i].hits << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (options.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.output);
+        file << json.str();
+        if (!file) {
+            std::cerr << "Error: no se pudo escribir " << options.output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include "color.h"
+#include "radiance.h"
 
 struct Light {
   glm::vec3 position;
   float intensity;
-  Color color;
+  Radiance color;
 };
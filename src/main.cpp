@@ -1,26 +1,33 @@
 #include <SDL2/SDL.h>
 #include <SDL_events.h>
 #include <SDL_render.h>
+#include <chrono>
 #include <cstdlib>
-#include <glm/ext/quaternion_geometric.hpp>
-#include <glm/geometric.hpp>
 #include <string>
 #include <glm/glm.hpp>
+#include <cstring>
+#include <exception>
 #include <vector>
-#include "./fps.h"
 #include "color.h"
-#include "intersect.h"
-#include "object.h"
-#include "cube.h"
-#include "light.h"
 #include "camera.h"
-#include "skybox.h"
 #include "globals.h"
+#include "framebuffer.h"
+#include "renderer.h"
+#include "options.h"
+#include "assets.h"
+#include "headless.h"
+#include "scenefile.h"
+#include "statsoverlay.h"
+#include "timeline.h"
 
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
-std::vector<Object*> objects;
-Light light = {glm::vec3(-10.0f, 10.0f, 20.0f), 1.0f, Color(255, 255, 255)};
+SDL_Texture* screenTexture = nullptr;
+// Doble buffer: se traza en uno mientras el otro se sube a la textura
+Framebuffer framebuffers[2] = {Framebuffer(WIDTH, HEIGHT), Framebuffer(WIDTH, HEIGHT)};
+// Copia del cuadro presentado con las estadísticas encima; el cuadro trazado no se toca
+Framebuffer overlayFrame(WIDTH, HEIGHT);
+StatsOverlay statsOverlay;
 Camera camera(glm::vec3(-3.0f, 2.0f, 10.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
 
 bool init() {
@@ -41,404 +48,117 @@ bool init() {
         return false;
     }
 
-    return true;
-}
+    screenTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, WIDTH, HEIGHT);
+    if (!screenTexture) {
+        std::cerr << "Error: No se pudo crear la textura de pantalla: " << SDL_GetError() << std::endl;
+        return false;
+    }
 
-void point(glm::vec2 position, Color color) {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    SDL_RenderDrawPoint(renderer, position.x, position.y);
+    return true;
 }
 
-float castShadow(const glm::vec3& shadowOrigin, const glm::vec3& lightDir, Object* hitObject) {
-    for (auto& obj : objects) {
-        if (obj != hitObject) {
-            Intersect shadowIntersect = obj->rayIntersect(shadowOrigin, lightDir);
-            if (shadowIntersect.isIntersecting && shadowIntersect.dist > 0) {
-                float shadowRatio = shadowIntersect.dist / glm::length(light.position - shadowOrigin);
-                shadowRatio = glm::min(1.0f, shadowRatio);
-                return 1.0f - shadowRatio;
-            }
-        }
+// Sube el framebuffer completo a la textura y la copia a la pantalla
+void present(const Framebuffer& frame) {
+    void* texturePixels;
+    int texturePitch;
+    if (SDL_LockTexture(screenTexture, nullptr, &texturePixels, &texturePitch) != 0) {
+        std::cerr << "Error: No se pudo bloquear la textura: " << SDL_GetError() << std::endl;
+        return;
     }
-    return 1.0f;
-}
-
-Color castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion = 0, Object* currentObj = nullptr) {
-    float zBuffer = 99999;
-    Object* hitObject = nullptr;
-    Intersect intersect;
-
-    for (const auto& object : objects) {
-        Intersect i = object->rayIntersect(rayOrigin, rayDirection);
-        if (i.isIntersecting && i.dist < zBuffer && currentObj != object) {
-            zBuffer = i.dist;
-            hitObject = object;
-            intersect = i;
+    const Uint8* src = reinterpret_cast<const Uint8*>(frame.pixels.data());
+    Uint8* dst = static_cast<Uint8*>(texturePixels);
+    if (texturePitch == frame.pitch()) {
+        std::memcpy(dst, src, frame.pixels.size() * sizeof(Color));
+    } else {
+        for (int y = 0; y < frame.height; y++) {
+            std::memcpy(dst + y * texturePitch, src + y * frame.pitch(), frame.pitch());
         }
     }
+    SDL_UnlockTexture(screenTexture);
 
-    if (!intersect.isIntersecting || recursion == MAX_RECURSION) {
-        return Skybox::getColor(rayOrigin, rayDirection);
-    }
-
-
-    glm::vec3 lightDir = glm::normalize(light.position - intersect.point);
-    glm::vec3 viewDir = glm::normalize(rayOrigin - intersect.point);
-    glm::vec3 reflectDir = glm::reflect(-glm::normalize(rayOrigin), intersect.normal);
-    
-
-    float shadowIntensity = castShadow(intersect.point, lightDir, hitObject);
-
-    float diffuseLightIntensity = std::max(0.0f, glm::dot(intersect.normal, lightDir));
-    float specReflection = glm::dot(viewDir, reflectDir);
-    
-    Material mat = hitObject->material;
-
-    float specLightIntensity = std::pow(std::max(0.0f, glm::dot(viewDir, reflectDir)), mat.specularCoefficient);
-
-
-    Color reflectedColor(0.0f, 0.0f, 0.0f);
-    if (mat.reflectivity > 0) {
-        glm::vec3 origin = intersect.point + intersect.normal * BIAS;
-        reflectedColor = castRay(origin, reflectDir, recursion + 1, hitObject); 
-    }
-
-    Color refractedColor(0.0f, 0.0f, 0.0f);
-    if (mat.transparency > 0) {
-        glm::vec3 origin = intersect.point - intersect.normal * BIAS;
-        glm::vec3 refractDir = glm::refract(rayDirection, intersect.normal, mat.refractionIndex);
-        refractedColor = castRay(origin, refractDir, recursion + 1, hitObject); 
-    }
-
-    Color materialLight = intersect.hasColor ? intersect.color : mat.diffuse;
-
-    Color diffuseLight = materialLight * light.intensity * diffuseLightIntensity * mat.albedo * shadowIntensity;
-    Color specularLight = light.color * light.intensity * specLightIntensity * mat.specularAlbedo * shadowIntensity;
-    Color color = (diffuseLight + specularLight) * (1.0f - mat.reflectivity - mat.transparency) + reflectedColor * mat.reflectivity + refractedColor * mat.transparency;
-    return color;
+    SDL_RenderCopy(renderer, screenTexture, nullptr, nullptr);
 }
 
-class Diamond : public Cube
-{
-public:
-    Diamond(const glm::vec3 &minBound, const glm::vec3 &maxBound, const Material &mat)
-            : Cube(minBound, maxBound, mat) {}
-
-    Intersect rayIntersect(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) const override
-    {
-        Intersect intersect = Cube::rayIntersect(rayOrigin, rayDirection);
-
-        const float epsilon = 0.0001;
-        if (glm::abs(intersect.point.y - maxBound.y) < epsilon)
-        {
-            // Añadir textura arriba
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.z - minBound.z), "diamond");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.z - maxBound.z) < epsilon || glm::abs(intersect.point.z - minBound.z) < epsilon){
-            // caras z
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.y - minBound.y), "diamond");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.x - minBound.x) < epsilon || glm::abs(intersect.point.x - maxBound.x) < epsilon){
-            // caras x
-            Color c = loadTexture(std::abs(intersect.point.z - minBound.z), std::abs(intersect.point.y - minBound.y), "diamond");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-
-        return intersect;
-    };
-};
-
-class Grass : public Cube
-{
-public:
-    Grass(const glm::vec3 &minBound, const glm::vec3 &maxBound, const Material &mat)
-            : Cube(minBound, maxBound, mat) {}
-
-    Intersect rayIntersect(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) const override
-    {
-        Intersect intersect = Cube::rayIntersect(rayOrigin, rayDirection);
-
-        const float epsilon = 0.0001;
-        if (glm::abs(intersect.point.y - maxBound.y) < epsilon)
-        {
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.z - minBound.z), "grass");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.z - maxBound.z) < epsilon || glm::abs(intersect.point.z - minBound.z) < epsilon){
-            // Tierra z
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.y - minBound.y), "grass_side");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.x - minBound.x) < epsilon || glm::abs(intersect.point.x - maxBound.x) < epsilon){
-            // Tierra x
-            Color c = loadTexture(std::abs(intersect.point.z - minBound.z), std::abs(intersect.point.y - minBound.y), "grass_side");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-
-        return intersect;
-    };
-};
-
-class Leaf : public Cube
-{
-public:
-    Leaf(const glm::vec3 &minBound, const glm::vec3 &maxBound, const Material &mat)
-            : Cube(minBound, maxBound, mat) {}
-
-    Intersect rayIntersect(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) const override
-    {
-        Intersect intersect = Cube::rayIntersect(rayOrigin, rayDirection);
-
-        const float epsilon = 0.0001;
-        if (glm::abs(intersect.point.y - maxBound.y) < epsilon)
-        {
-            // Añadir textura arriba
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.z - minBound.z), "leaf");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.z - maxBound.z) < epsilon || glm::abs(intersect.point.z - minBound.z) < epsilon){
-            // caras z
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.y - minBound.y), "leaf");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.x - minBound.x) < epsilon || glm::abs(intersect.point.x - maxBound.x) < epsilon){
-            // caras x
-            Color c = loadTexture(std::abs(intersect.point.z - minBound.z), std::abs(intersect.point.y - minBound.y), "leaf");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-
-        return intersect;
-    };
-};
-
-class Oak : public Cube
-{
-public:
-    Oak(const glm::vec3 &minBound, const glm::vec3 &maxBound, const Material &mat)
-            : Cube(minBound, maxBound, mat) {}
-
-    Intersect rayIntersect(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) const override
-    {
-        Intersect intersect = Cube::rayIntersect(rayOrigin, rayDirection);
-
-        const float epsilon = 0.0001;
-        if (glm::abs(intersect.point.y - maxBound.y) < epsilon)
-        {
-            // Añadir textura arriba
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.z - minBound.z), "oak_side");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.z - maxBound.z) < epsilon || glm::abs(intersect.point.z - minBound.z) < epsilon){
-            // caras z
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.y - minBound.y), "oak_side");
-
-            intersect.color = c;
-            intersect.hasColor = true;
+int main(int argc, char* argv[]) {
+    StartupTimeline::start();
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless") {
+            return runHeadless(argc, argv);
         }
-        else if (glm::abs(intersect.point.x - minBound.x) < epsilon || glm::abs(intersect.point.x - maxBound.x) < epsilon){
-            // caras x
-            Color c = loadTexture(std::abs(intersect.point.z - minBound.z), std::abs(intersect.point.y - minBound.y), "oak_side");
+    }
 
-            intersect.color = c;
-            intersect.hasColor = true;
+    Renderer raytracer(WIDTH, HEIGHT);
+    unsigned threads = 0;
+    std::string scenePath;
+    std::string packPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::string(argv[i]) == "--scene" && i + 1 < argc) {
+            scenePath = argv[++i];
+        } else if (std::string(argv[i]) == "--pack" && i + 1 < argc) {
+            packPath = argv[++i];
+        } else if (std::string(argv[i]) == "--stats-csv" && i + 1 < argc) {
+            statsOverlay.openCsv(argv[++i]);
+        } else if (std::string(argv[i]) == "--no-overlay") {
+            statsOverlay.setVisible(false);
+        } else {
+            parseRenderOption(raytracer, argc, argv, i);
         }
+    }
 
-        return intersect;
-    };
-};
-
-class Plank : public Cube
-{
-public:
-    Plank(const glm::vec3 &minBound, const glm::vec3 &maxBound, const Material &mat)
-            : Cube(minBound, maxBound, mat) {}
-
-    Intersect rayIntersect(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) const override
     {
-        Intersect intersect = Cube::rayIntersect(rayOrigin, rayDirection);
-
-        const float epsilon = 0.0001;
-        if (glm::abs(intersect.point.y - maxBound.y) < epsilon)
-        {
-            // Añadir textura arriba
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.z - minBound.z), "plank");
-
-            intersect.color = c;
-            intersect.hasColor = true;
+        StartupTimeline::Scope timing("abrir la ventana");
+        if (!init()) {
+            return 1;
         }
-        else if (glm::abs(intersect.point.z - maxBound.z) < epsilon || glm::abs(intersect.point.z - minBound.z) < epsilon){
-            // caras z
-            Color c = loadTexture(std::abs(intersect.point.x - minBound.x), std::abs(intersect.point.y - minBound.y), "plank");
-
-            intersect.color = c;
-            intersect.hasColor = true;
-        }
-        else if (glm::abs(intersect.point.x - minBound.x) < epsilon || glm::abs(intersect.point.x - maxBound.x) < epsilon){
-            // caras x
-            Color c = loadTexture(std::abs(intersect.point.z - minBound.z), std::abs(intersect.point.y - minBound.y), "plank");
+    }
 
-            intersect.color = c;
-            intersect.hasColor = true;
+    // Sin --scene se usa la diorama compilada en el programa
+    SceneDocument sceneFile;
+    try {
+        if (!packPath.empty()) {
+            loadPack(packPath, std::cout);
         }
-
-        return intersect;
-    };
-};
-
-void setUp() {
-    // Define materials
-    Material grass = {
-            Color(0, 0, 0),
-            0.85,
-            0.0,
-            0.50f,
-            0.0f,
-            0.0f
-    };
-    Material wood = {
-            Color(0, 0, 0),
-            0.85,
-            0.0,
-            0.50f,
-            0.0f,
-            0.0f
-    };
-
-    Material leaf = {
-            Color(0, 0, 0),
-            0.85,
-            0.0,
-            0.50f,
-            0.0f,
-            0.0f
-    };
-
-    Material diamond = {
-            Color(0, 0, 0),
-            0.85,
-            0.4,
-            2.50f,
-            0.0f,
-            0.0f
-    };
-
-    // Scene
-    // Grass floor
-    objects.push_back(new Grass(glm::vec3(-3.0f, -0.5f, -5.0f), glm::vec3(10.0f, 0.5f, 5.0f), grass));
-
-    // Tree
-    // Wood
-    objects.push_back(new Oak(glm::vec3(-2.0f, 0.5f, -2.0f), glm::vec3(-1.0f, 3.5f, -1.0f), wood));
-    // Leaves
-    objects.push_back(new Leaf(glm::vec3(-3.0f, 3.5f, -3.0f), glm::vec3(0.0f, 4.5f, 0.0f), leaf));
-    objects.push_back(new Leaf(glm::vec3(-2.0f, 4.5f, -2.0f), glm::vec3(-1.0f, 5.5f, -1.0f), leaf));
-
-    // Diamond
-    objects.push_back(new Diamond(glm::vec3(-2.0f, 0.5f, 2.0f), glm::vec3(1.0f, 1.5f, 1.0f), diamond));
-    objects.push_back(new Diamond(glm::vec3(-1.0f, 1.5f, 2.0f), glm::vec3(0.0f, 2.5f, 1.0f), diamond));
-    objects.push_back(new Diamond(glm::vec3(-1.0f, 0.5f, 2.0f), glm::vec3(0.0f, 1.5f, 3.0f), diamond));
-
-    // House
-    // Pared atras
-    objects.push_back(new Plank(glm::vec3(3.0f, 0.5f, -4.0f), glm::vec3(7.0f, 4.5f, -3.0f), wood));
-    // Techo 1
-    objects.push_back(new Plank(glm::vec3(2.0f, 3.5f, -3.0f), glm::vec3(8.0f, 4.5f, 0.0f), wood));
-    // Techo 2
-    objects.push_back(new Plank(glm::vec3(3.0f, 3.5f, 0.0f), glm::vec3(7.0f, 4.5f, 1.0f), wood));
-    // Pared lateral 1
-    objects.push_back(new Plank(glm::vec3(2.0f, 0.5f, -3.0f), glm::vec3(3.0f, 3.5f, 0.0f), wood));
-    // Pared lateral 2
-    objects.push_back(new Plank(glm::vec3(7.0f, 0.5f, -3.0f), glm::vec3(8.0f, 3.5f, 0.0f), wood));
-    // Columna 1
-    objects.push_back(new Oak(glm::vec3(2.0f, 0.5f, 0.0f), glm::vec3(3.0f, 4.5f, 1.0f), wood));
-    // Columna 2
-    objects.push_back(new Oak(glm::vec3(7.0f, 0.5f, 0.0f), glm::vec3(8.0f, 4.5f, 1.0f), wood));
-    // Columna 3
-    objects.push_back(new Oak(glm::vec3(2.0f, 0.5f, -4.0f), glm::vec3(3.0f, 4.5f, -3.0f), wood));
-    // Columna 4
-    objects.push_back(new Oak(glm::vec3(7.0f, 0.5f, -4.0f), glm::vec3(8.0f, 4.5f, -3.0f), wood));
-    // Pared frontal
-    objects.push_back(new Plank(glm::vec3(3.0f, 0.5f, 0.0f), glm::vec3(5.0f, 3.5f, 1.0f), wood));
-    // Puerta
-    objects.push_back(new Plank(glm::vec3(6.0f, 0.5f, 0.0f), glm::vec3(7.0f, 3.5f, 1.0f), wood));
-
-}
-
-
-void render() {
-    float fov = 3.1415/3;
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            float screenX = (2.0f * (x + 0.5f)) / WIDTH - 1.0f;
-            float screenY = -(2.0f * (y + 0.5f)) / HEIGHT + 1.0f;
-            screenX *= RATIO;
-            screenX *= tan(fov/2.0f);
-            screenY *= tan(fov/2.0f);
-
-
-            glm::vec3 cameraDir = glm::normalize(camera.target - camera.position);
-
-            glm::vec3 cameraX = glm::normalize(glm::cross(cameraDir, camera.up));
-            glm::vec3 cameraY = glm::normalize(glm::cross(cameraX, cameraDir));
-            glm::vec3 rayDirection = glm::normalize(
-                cameraDir + cameraX * screenX + cameraY * screenY
-            );
-           
-            Color pixelColor = castRay(camera.position, rayDirection);
-
-            point(glm::vec2(x, y), pixelColor);
+        if (scenePath.empty()) {
+            loadAssets(threads);
+            StartupTimeline::Scope timing("armar la escena");
+            setUp(raytracer.scene);
+        } else {
+            {
+                StartupTimeline::Scope timing("abrir " + scenePath);
+                sceneFile = SceneFile::open(scenePath);
+            }
+            loadAssets(sceneFile, threads);
+            StartupTimeline::Scope timing("armar la escena");
+            sceneFile.apply(raytracer);
         }
-    }
-}
-
-int main(int argc, char* argv[]) {
-
-     if (!init()) {
+    } catch (const std::exception& error) {
+        std::cerr << "Error: " << error.what() << std::endl;
         return 1;
     }
-
-    ImageLoader::loadImage("grass", "../assets/grass.png", 800.0f, 800.0f);
-    ImageLoader::loadImage("grass_side", "../assets/grass_side.png", 800.0f, 800.0f);
-    ImageLoader::loadImage("plank", "../assets/oak_plank.png", 358.0f, 358.0f);
-    ImageLoader::loadImage("oak_side", "../assets/oak_side.png", 320.0f, 318.0f);
-    ImageLoader::loadImage("leaf", "../assets/leaf.png", 500.0f, 500.0f);
-    ImageLoader::loadImage("diamond", "../assets/diamond_ore.png", 256.0f, 256.0f);
-    ImageLoader::loadImage("skybox1", "../assets/skybox_1.png", 793.0f, 877.0f);
-    ImageLoader::loadImage("skybox2", "../assets/skybox_2.png", 795.0f, 877.0f);
-    ImageLoader::loadImage("skybox3", "../assets/skybox_3.png", 792.0f, 877.0f);
-    ImageLoader::loadImage("skybox4", "../assets/skybox_4.png", 792.0f, 877.0f);
-    ImageLoader::loadImage("skybox_ground", "../assets/skyboxground.png", 322.0f, 282.0f);
-    ImageLoader::loadImage("skybox_sky", "../assets/skybox_sky.png", 1080.0f, 1080.0f);
+    if (sceneFile.hasCamera) {
+        camera.position = sceneFile.cameraPosition;
+        camera.target = sceneFile.cameraTarget;
+    }
 
     bool running = true;
     SDL_Event event;
-
-    setUp();
+    int backBuffer = 0;
+
+    // Desde aquí las texturas se leen desde varios hilos sin locks (salvo la
+    // primera vez que se pide una diferida)
+    ImageLoader::freeze();
+    raytracer.start(threads);
+    raytracer.reportBuild(std::cout);
+    if (!scenePath.empty()) {
+        SceneFile::updateCache(sceneFile, raytracer, std::cout);
+    }
+    auto lastReport = std::chrono::steady_clock::now();
+    bool firstFrame = true;
 
     while (running) {
-        //startFPS();
+        auto frameStart = std::chrono::steady_clock::now();
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
@@ -470,6 +190,21 @@ int main(int argc, char* argv[]) {
                     case SDLK_LEFT:
                         camera.moveX(-1.0f);
                         break;
+                    case SDLK_1:
+                        raytracer.selectAccelerator(0);
+                        break;
+                    case SDLK_2:
+                        raytracer.selectAccelerator(1);
+                        break;
+                    case SDLK_3:
+                        raytracer.selectAccelerator(2);
+                        break;
+                    case SDLK_p:
+                        raytracer.setUsePackets(!raytracer.getUsePackets());
+                        break;
+                    case SDLK_o:
+                        statsOverlay.setVisible(!statsOverlay.isVisible());
+                        break;
                  }
             }
 
@@ -480,17 +215,49 @@ int main(int argc, char* argv[]) {
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        render();
+        // Se traza el cuadro nuevo mientras se sube el anterior. Con la imagen
+        // ya convergida no se traza: se sigue mostrando el último cuadro.
+        raytracer.beginFrame(camera, framebuffers[backBuffer]);
+        auto presentStart = std::chrono::steady_clock::now();
+        if (statsOverlay.isVisible()) {
+            overlayFrame.pixels = framebuffers[1 - backBuffer].pixels;
+            statsOverlay.draw(overlayFrame);
+            present(overlayFrame);
+        } else {
+            present(framebuffers[1 - backBuffer]);
+        }
 
         // Present the renderer
         SDL_RenderPresent(renderer);
-        //endFPS(window);
+        double presentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - presentStart).count();
+
+        if (raytracer.endFrame()) {
+            backBuffer = 1 - backBuffer;
+        } else {
+            SDL_Delay(16);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (firstFrame) {
+            StartupTimeline::record("primer cuadro", frameStart, now);
+            StartupTimeline::report(std::cout, "Arranque");
+            firstFrame = false;
+        }
+        statsOverlay.addFrame(std::chrono::duration<double, std::milli>(now - frameStart).count(), presentMs);
+        if (now - lastReport >= std::chrono::seconds(1)) {
+            statsOverlay.update(raytracer, std::chrono::duration<double>(now - lastReport).count());
+            raytracer.report(std::cout);
+            // Caras del cielo e imágenes diferidas que se cargaron en este intervalo
+            StartupTimeline::report(std::cout, "Carga diferida");
+            lastReport = now;
+        }
 
     }
         // Cleanup
+        SDL_DestroyTexture(screenTexture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Archivo completo proyectado en memoria de solo lectura. Las páginas se leen
+// del disco (o de la caché del sistema) recién cuando se tocan.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("Unable to open " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length > 0) {
+      mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      bytes = mapping ? static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    }
+#else
+    descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+      throw std::runtime_error("Unable to open " + path);
+    }
+    struct stat info;
+    fstat(descriptor, &info);
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+      void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      bytes = (address == MAP_FAILED) ? nullptr : static_cast<const std::uint8_t*>(address);
+    }
+#endif
+    if (length > 0 && !bytes) {
+      release();
+      throw std::runtime_error("Unable to map " + path);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+    release();
+  }
+
+  const std::uint8_t* data() const {
+    return bytes;
+  }
+
+  size_t size() const {
+    return length;
+  }
+
+private:
+  void release() {
+#ifdef _WIN32
+    if (bytes) {
+      UnmapViewOfFile(bytes);
+    }
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+      CloseHandle(file);
+    }
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#else
+    if (bytes) {
+      munmap(const_cast<std::uint8_t*>(bytes), length);
+    }
+    if (descriptor >= 0) {
+      close(descriptor);
+    }
+    descriptor = -1;
+#endif
+    bytes = nullptr;
+  }
+
+  const std::uint8_t* bytes = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+#else
+  int descriptor = -1;
+#endif
+};
@@ -1,9 +1,9 @@
 #pragma once
 
-#include "color.h"
+#include "radiance.h"
 
 struct Material {
-  Color diffuse;
+  Radiance diffuse;
   float albedo;
   float specularAlbedo;
   float specularCoefficient;
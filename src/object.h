@@ -3,11 +3,26 @@
 #include <glm/glm.hpp>
 #include "material.h"
 #include "intersect.h"
+#include "aabb.h"
+#include "ray.h"
 
 class Object {
 public:
   Object(const Material& mat) : material(mat) {}
-  virtual Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const = 0;
+  // Impacto sin recortar: quien llama compara hit.dist con [tMin, tMax]
+  virtual Intersect rayIntersect(const Ray& ray) const = 0;
+  virtual AABB bounds() const = 0;
+
+  // Consulta de sombra: ¿hay impacto con distancia en (tMin, tMax)? No calcula
+  // normal ni color. Por defecto usa rayIntersect completo.
+  virtual bool occluded(const Ray& ray, float& hitDist) const {
+    Intersect hit = rayIntersect(ray);
+    if (hit.isIntersecting && hit.dist > ray.tMin && hit.dist < ray.tMax) {
+      hitDist = hit.dist;
+      return true;
+    }
+    return false;
+  }
   
   Material material;
 };
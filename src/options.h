@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+#include "renderer.h"
+
+// Opciones de línea de comandos del render, comunes al modo interactivo y al
+// modo sin pantalla. Si argv[i] es una de ellas la aplica (avanzando i sobre su
+// argumento) y devuelve true.
+inline bool parseRenderOption(Renderer& renderer, int argc, char* argv[], int& i) {
+    std::string option = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (option == "--accel" && hasValue) {
+        renderer.setAccelerator(argv[++i]);
+    } else if (option == "--no-packets") {
+        renderer.setUsePackets(false);
+    } else if (option == "--projection" && hasValue) {
+        std::string name = argv[++i];
+        if (name == "ortho") {
+            renderer.rayGenerator.setProjection(Projection::Orthographic);
+        } else if (name == "equirect") {
+            renderer.rayGenerator.setProjection(Projection::Equirectangular);
+        } else {
+            renderer.rayGenerator.setProjection(Projection::Perspective);
+        }
+    } else if (option == "--tonemap" && hasValue) {
+        std::string name = argv[++i];
+        if (name == "reinhard") {
+            renderer.tonemapper.setToneMap(ToneMap::Reinhard);
+        } else if (name == "aces") {
+            renderer.tonemapper.setToneMap(ToneMap::Aces);
+        } else {
+            renderer.tonemapper.setToneMap(ToneMap::Clamp);
+        }
+    } else if (option == "--exposure" && hasValue) {
+        renderer.tonemapper.setExposure(static_cast<float>(std::atof(argv[++i])));
+    } else if (option == "--no-reuse") {
+        renderer.reprojection.setEnabled(false);
+    } else if (option == "--aa-budget" && hasValue) {
+        renderer.adaptive.setBudget(static_cast<float>(std::atof(argv[++i])));
+    } else if (option == "--no-progressive") {
+        renderer.progressive.setEnabled(false);
+    } else if (option == "--preview-scale" && hasValue) {
+        renderer.progressive.setPreviewScale(std::atoi(argv[++i]));
+    } else if (option == "--samples" && hasValue) {
+        renderer.progressive.setMaxSamples(std::atoi(argv[++i]));
+    } else {
+        return false;
+    }
+    return true;
+}
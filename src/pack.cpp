@@ -0,0 +1,71 @@
+// sr1_pack: decodifica las texturas de la diorama (o de archivos de escena),
+// hornea el cielo y escribe todo en un paquete que el programa proyecta con
+// --pack en lugar de leer y decodificar los PNG al arrancar.
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+#include "assets.h"
+#include "diorama.h"
+#include "imagefile.h"
+#include "scenefile.h"
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::vector<std::string> scenes;
+    bool includeSky = true;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--scene" && i + 1 < argc) {
+            scenes.push_back(argv[++i]);
+        } else if (option == "--no-sky") {
+            includeSky = false;
+        } else if (output.empty() && option.rfind("--", 0) != 0) {
+            output = option;
+        } else {
+            std::cerr << "Aviso: opción ignorada: " << option << std::endl;
+        }
+    }
+    if (output.empty()) {
+        std::cerr << "Uso: sr1_pack SALIDA.sr1pack [--scene ARCHIVO]... [--no-sky]" << std::endl;
+        return 1;
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        // Sin --scene se empaqueta la diorama; las claves repetidas entre
+        // escenas quedan una vez, con la imagen de la última
+        std::vector<std::string> keys;
+        auto addKey = [&keys](const std::string& key) {
+            if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+                keys.push_back(key);
+            }
+        };
+        if (scenes.empty()) {
+            loadAssets();
+            for (const TextureEntry& entry : DIORAMA_TEXTURES) {
+                addKey(entry.key);
+            }
+        }
+        for (const std::string& path : scenes) {
+            SceneDocument document = SceneFile::open(path);
+            loadAssets(document);
+            for (const TextureBinding& texture : document.textures) {
+                addKey(texture.key);
+            }
+        }
+
+        AssetPack::write(output, keys, includeSky);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Paquete " << output << ": " << keys.size() << " texturas" << (includeSky ? " y el cielo horneado" : "")
+                  << " en " << ms << " ms" << std::endl;
+    } catch (const std::exception& error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+    ImageFile::quit();
+    return 0;
+}
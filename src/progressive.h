@@ -0,0 +1,164 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "camera.h"
+#include "framebuffer.h"
+#include "radiance.h"
+
+// Qué traza render() en un cuadro
+struct ProgressivePass {
+  enum Mode {
+    Full,      // un rayo por píxel, sin acumular (modo progresivo apagado)
+    Preview,   // un rayo por bloque de scale x scale píxeles, ampliado
+    Refine,    // una muestra más por píxel, desplazada `jitter`, que se acumula
+    Done,      // convergió: no se traza nada y se vuelve a mostrar el último cuadro
+    Reproject, // resolución completa reutilizando el cuadro anterior (lo decide main, ver Reprojection)
+  };
+  Mode mode = Full;
+  int scale = 1;
+  int sample = 0;       // índice de la muestra en Refine
+  glm::vec2 jitter = glm::vec2(0.0f);
+};
+
+// Refinamiento progresivo: mientras la cámara cambia se traza una vista previa
+// a baja resolución; cuando se queda quieta, cada cuadro suma una muestra
+// desplazada por píxel al buffer de acumulación hasta llegar a maxSamples, y
+// después se deja de trazar. Mide el tiempo desde el último cambio de cámara
+// hasta la primera imagen y hasta la imagen convergida.
+class Progressive {
+public:
+  Progressive(int width, int height, int previewScale = 4, int maxSamples = 16)
+    : accumulation(width, height), previewScale(previewScale), maxSamples(maxSamples) {}
+
+  void setEnabled(bool value) {
+    enabled = value;
+  }
+
+  // Lado del bloque de la vista previa: 2 traza 1/4 de los píxeles, 4 traza 1/16
+  void setPreviewScale(int scale) {
+    previewScale = std::max(1, scale);
+  }
+
+  void setMaxSamples(int samples) {
+    maxSamples = std::max(1, samples);
+  }
+
+  // Decide la pasada del cuadro; llamar una vez por cuadro antes de render()
+  const ProgressivePass& beginFrame(const Camera& camera) {
+    auto now = Clock::now();
+    bool changed = !started || camera.position != lastPosition || camera.target != lastTarget || camera.up != lastUp;
+    if (changed) {
+      started = true;
+      lastPosition = camera.position;
+      lastTarget = camera.target;
+      lastUp = camera.up;
+      lastChange = now;
+      samples = 0;
+      firstImagePending = true;
+      convergedReported = false;
+    }
+
+    if (!enabled) {
+      pass = ProgressivePass{};
+    } else if (samples >= maxSamples) {
+      pass = ProgressivePass{ProgressivePass::Done};
+    } else if (previewScale > 1 && (changed || now - lastChange < SETTLE_TIME)) {
+      // Las teclas repetidas llegan cada pocos cuadros: se sigue en vista previa
+      // hasta que la cámara lleva SETTLE_TIME quieta
+      pass = ProgressivePass{ProgressivePass::Preview, previewScale};
+    } else {
+      pass = ProgressivePass{ProgressivePass::Refine, 1, samples, samples == 0 ? glm::vec2(0.0f) : jitter(samples)};
+    }
+    return pass;
+  }
+
+  // Llamar cuando terminó el render() del cuadro
+  void endFrame() {
+    if (pass.mode == ProgressivePass::Done) {
+      return;
+    }
+    auto now = Clock::now();
+    if (firstImagePending) {
+      firstImageMs = milliseconds(now - lastChange);
+      firstImagePending = false;
+    }
+    if (pass.mode == ProgressivePass::Refine) {
+      samples++;
+      if (samples >= maxSamples && !convergedReported) {
+        convergedMs = milliseconds(now - lastChange);
+        convergedReported = true;
+        std::cout << "Progresivo: primera imagen en " << firstImageMs << " ms, convergida en " << convergedMs
+                  << " ms (" << samples << " muestras por píxel)" << std::endl;
+      }
+    }
+  }
+
+  // Suma la muestra del cuadro en el rectángulo [x0, x1) x [y0, y1) y deja en
+  // `frame` el promedio acumulado
+  void accumulate(HdrFramebuffer& frame, int x0, int y0, int x1, int y1) {
+    float weight = 1.0f / (pass.sample + 1);
+    for (int y = y0; y < y1; y++) {
+      for (int x = x0; x < x1; x++) {
+        Radiance& sum = accumulation.at(x, y);
+        sum = (pass.sample == 0) ? frame.at(x, y) : sum + frame.at(x, y);
+        frame.at(x, y) = sum * weight;
+      }
+    }
+  }
+
+  const ProgressivePass& currentPass() const {
+    return pass;
+  }
+
+  bool converged() const {
+    return pass.mode == ProgressivePass::Done;
+  }
+
+  double timeToFirstImageMs() const {
+    return firstImageMs;
+  }
+
+  double timeToConvergedMs() const {
+    return convergedMs;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr std::chrono::milliseconds SETTLE_TIME{150};
+
+  static double milliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  // Desplazamiento de la muestra dentro del píxel: secuencia de Halton (2, 3)
+  static glm::vec2 jitter(int index) {
+    return glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f;
+  }
+
+  static float halton(int index, int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    for (int i = index; i > 0; i /= base) {
+      result += fraction * (i % base);
+      fraction /= base;
+    }
+    return result;
+  }
+
+  HdrFramebuffer accumulation;
+  bool enabled = true;
+  int previewScale;
+  int maxSamples;
+
+  ProgressivePass pass;
+  int samples = 0;
+  bool started = false;
+  glm::vec3 lastPosition, lastTarget, lastUp;
+  Clock::time_point lastChange;
+  bool firstImagePending = true;
+  bool convergedReported = false;
+  double firstImageMs = 0.0;
+  double convergedMs = 0.0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <array>
+#include <cmath>
+#include "color.h"
+
+// Radiancia lineal RGB en float. Es lo que circula por el sombreado: se suma y
+// escala sin recortar ni cuantizar, y solo el tonemap final la pasa a Color.
+using Radiance = glm::vec3;
+
+inline float srgbToLinear(float value) {
+  return (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linearToSrgb(float value) {
+  return (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// Tabla de decodificación de los 256 valores de un canal sRGB de 8 bits
+inline const std::array<float, 256> SRGB_TO_LINEAR = [] {
+  std::array<float, 256> table;
+  for (int i = 0; i < 256; i++) {
+    table[i] = srgbToLinear(i / 255.0f);
+  }
+  return table;
+}();
+
+// Texels y colores de entrada están en sRGB de 8 bits
+inline Radiance toRadiance(const Color& color) {
+  return Radiance(SRGB_TO_LINEAR[color.r], SRGB_TO_LINEAR[color.g], SRGB_TO_LINEAR[color.b]);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+#include <limits>
+
+// 1 / dirección sin infinitos: una componente cero da un inverso enorme pero
+// finito, así (plano - origen) * inverso nunca es 0 * inf = NaN.
+inline glm::vec3 safeInverse(const glm::vec3& rayDirection) {
+  glm::vec3 inverse;
+  for (int axis = 0; axis < 3; axis++) {
+    float d = rayDirection[axis];
+    inverse[axis] = 1.0f / ((d == 0.0f) ? std::copysign(1e-30f, d) : d);
+  }
+  return inverse;
+}
+
+// Rayo con lo que se precalcula una sola vez: dirección inversa, signos por eje
+// y el intervalo [tMin, tMax] de distancias válidas. La búsqueda del impacto
+// más cercano achica tMax a medida que encuentra impactos; las sombras lo fijan
+// en la distancia a la luz.
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;
+  glm::vec3 invDir;
+  int sign[3]; // 1 si el rayo avanza hacia -eje: el plano cercano es el máximo
+  float tMin;
+  float tMax;
+
+  Ray(const glm::vec3& origin, const glm::vec3& direction, float tMin = 0.0f,
+      float tMax = std::numeric_limits<float>::infinity())
+    : origin(origin), direction(direction), invDir(safeInverse(direction)), tMin(tMin), tMax(tMax) {
+    for (int axis = 0; axis < 3; axis++) {
+      sign[axis] = invDir[axis] < 0.0f ? 1 : 0;
+    }
+  }
+
+  glm::vec3 at(float t) const {
+    return origin + t * direction;
+  }
+};
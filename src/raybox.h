@@ -0,0 +1,105 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ray.h"
+
+// Núcleo de intersección rayo/caja compartido por todas las pruebas de bloques.
+
+// Caras de una caja: eje * 2, +1 para la cara del lado máximo
+enum BoxFace {
+  FACE_NONE = -1,
+  FACE_MIN_X,
+  FACE_MAX_X,
+  FACE_MIN_Y,
+  FACE_MAX_Y,
+  FACE_MIN_Z,
+  FACE_MAX_Z,
+};
+
+// Holgura del slab test: tFar se agranda 2 * gamma(3) ulps relativos para que
+// el redondeo no deje rendijas en aristas y esquinas compartidas (Ize 2013,
+// "Robust BVH Ray Traversal").
+constexpr float SLAB_TOLERANCE = 1.0f + 2.0f * (3.0f * std::numeric_limits<float>::epsilon() * 0.5f) /
+                                          (1.0f - 3.0f * std::numeric_limits<float>::epsilon() * 0.5f);
+
+// Distancia de impacto dentro de [tMin, tMax] a partir de las distancias de
+// entrada y salida de la caja: tNear, o tFar si el rayo empieza adentro.
+inline bool clipToRay(const Ray& ray, float tNear, float tFar, float& dist) {
+  dist = (tNear < ray.tMin) ? tFar : tNear;
+  return dist >= ray.tMin && dist <= ray.tMax;
+}
+
+inline glm::vec3 faceNormal(int face) {
+  glm::vec3 normal(0.0f);
+  if (face != FACE_NONE) {
+    normal[face / 2] = (face % 2) ? 1.0f : -1.0f;
+  }
+  return normal;
+}
+
+// Ejes de las coordenadas de cada cara: (x, z) arriba y abajo, (x, y) en las
+// caras z, (z, y) en las caras x
+inline void faceAxes(int face, int& uAxis, int& vAxis) {
+  switch (face / 2) {
+    case 0:
+      uAxis = 2;
+      vAxis = 1;
+      break;
+    case 1:
+      uAxis = 0;
+      vAxis = 2;
+      break;
+    default:
+      uAxis = 0;
+      vAxis = 1;
+  }
+}
+
+// Coordenadas del punto sobre la cara, en unidades de escena desde la esquina
+// mínima, con los ejes de faceAxes
+inline glm::vec2 faceUV(const glm::vec3& minBound, const glm::vec3& maxBound, const glm::vec3& point, int face) {
+  int uAxis, vAxis;
+  faceAxes(face, uAxis, vAxis);
+  return glm::vec2(std::clamp(point[uAxis] - minBound[uAxis], 0.0f, maxBound[uAxis] - minBound[uAxis]),
+                   std::clamp(point[vAxis] - minBound[vAxis], 0.0f, maxBound[vAxis] - minBound[vAxis]));
+}
+
+struct BoxHit {
+  float dist = 0.0f;    // tNear, o tFar si el rayo empieza adentro
+  int face = FACE_NONE; // cara por la que entra (o sale, desde adentro)
+  glm::vec2 uv;         // ver faceUV
+};
+
+// Slab test con la cara y las coordenadas del impacto tomadas del mismo
+// cálculo: la cara es el plano que dio tNear (tFar desde adentro), sin comparar
+// el punto con los bordes. Los signos del rayo eligen el plano cercano de cada
+// eje, sin min/max.
+inline bool rayBox(const glm::vec3& minBound, const glm::vec3& maxBound, const Ray& ray, BoxHit& hit) {
+  const glm::vec3* planes[2] = {&minBound, &maxBound};
+  glm::vec3 tmin, tmax;
+  for (int axis = 0; axis < 3; axis++) {
+    tmin[axis] = ((*planes[ray.sign[axis]])[axis] - ray.origin[axis]) * ray.invDir[axis];
+    tmax[axis] = ((*planes[1 - ray.sign[axis]])[axis] - ray.origin[axis]) * ray.invDir[axis];
+  }
+
+  float tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
+  float tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+
+  if (tNear > tFar * SLAB_TOLERANCE || !clipToRay(ray, tNear, tFar, hit.dist)) {
+    return false;
+  }
+
+  bool inside = tNear < ray.tMin;
+  const glm::vec3& axisDist = inside ? tmax : tmin;
+  int axis = (axisDist.x == hit.dist) ? 0 : ((axisDist.y == hit.dist) ? 1 : 2);
+  // Avanzando en +eje se entra por el lado mínimo y se sale por el máximo
+  bool maxSide = (ray.sign[axis] == 1) != inside;
+  hit.face = axis * 2 + (maxSide ? 1 : 0);
+
+  glm::vec3 point = ray.at(hit.dist);
+  point[axis] = maxSide ? maxBound[axis] : minBound[axis];
+  hit.uv = faceUV(minBound, maxBound, point, hit.face);
+  return true;
+}
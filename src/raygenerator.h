@@ -0,0 +1,230 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "camera.h"
+#include "raypacket.h"
+
+enum class Projection {
+  Perspective,
+  Orthographic,
+  Equirectangular,
+};
+
+// Genera los rayos primarios. Las tablas por columna y fila dependen solo de
+// la resolución, la proyección y el FOV; la base de la cámara se calcula una
+// vez por cuadro en update().
+class RayGenerator {
+public:
+  RayGenerator(int width, int height, Projection projection = Projection::Perspective,
+               float fov = 3.1415 / 3, float orthoHeight = 10.0f)
+    : projection(projection), fov(fov), orthoHeight(orthoHeight) {
+    resize(width, height);
+  }
+
+  void resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    rebuildTables();
+  }
+
+  void setProjection(Projection newProjection) {
+    projection = newProjection;
+    rebuildTables();
+  }
+
+  // fov en radianes (perspectiva); orthoHeight es el alto visible en unidades de escena
+  void setFov(float newFov) {
+    fov = newFov;
+    rebuildTables();
+  }
+
+  void setOrthoHeight(float newOrthoHeight) {
+    orthoHeight = newOrthoHeight;
+    rebuildTables();
+  }
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+  Projection getProjection() const {
+    return projection;
+  }
+
+  const glm::vec3& getPosition() const {
+    return position;
+  }
+
+  // Base de la cámara para el cuadro; llamar antes de generar rayos
+  void update(const Camera& camera) {
+    position = camera.position;
+    cameraDir = glm::normalize(camera.target - camera.position);
+    cameraX = glm::normalize(glm::cross(cameraDir, camera.up));
+    cameraY = glm::normalize(glm::cross(cameraX, cameraDir));
+  }
+
+  // `offset` desplaza el rayo dentro del píxel, en píxeles desde el centro
+  // ([-0.5, 0.5]); sin desplazamiento se usan las tablas tal cual.
+  glm::vec3 origin(int x, int y, const glm::vec2& offset = glm::vec2(0.0f)) const {
+    if (projection == Projection::Orthographic) {
+      return position + cameraX * (columns[x].x + offset.x * pixelStep.x) + cameraY * (rows[y].x + offset.y * pixelStep.y);
+    }
+    return position;
+  }
+
+  glm::vec3 direction(int x, int y, const glm::vec2& offset = glm::vec2(0.0f)) const {
+    switch (projection) {
+      case Projection::Orthographic:
+        return cameraDir;
+      case Projection::Equirectangular: {
+        // columnas: (cos, sen) de la longitud; filas: (cos, sen) de la latitud
+        glm::vec2 lon = columns[x];
+        glm::vec2 lat = rows[y];
+        if (offset.x != 0.0f || offset.y != 0.0f) {
+          float longitude = std::atan2(lon.y, lon.x) + offset.x * pixelStep.x;
+          float latitude = std::asin(lat.y) + offset.y * pixelStep.y;
+          lon = glm::vec2(std::cos(longitude), std::sin(longitude));
+          lat = glm::vec2(std::cos(latitude), std::sin(latitude));
+        }
+        return glm::normalize(cameraDir * (lat.x * lon.x) + cameraX * (lat.x * lon.y) + cameraY * lat.y);
+      }
+      default:
+        return glm::normalize(cameraDir + cameraX * (columns[x].x + offset.x * pixelStep.x) +
+                              cameraY * (rows[y].x + offset.y * pixelStep.y));
+    }
+  }
+
+  // Inversa de direction(): posición continua en la imagen (el píxel x cubre
+  // [x, x + 1)) del punto del mundo visto desde la cámara actual. Devuelve false
+  // si queda detrás de la cámara.
+  bool projectPoint(const glm::vec3& point, glm::vec2& pixel) const {
+    return project(point - position, projection != Projection::Orthographic, pixel);
+  }
+
+  // Igual para una dirección (un punto en el infinito, como el cielo). En
+  // ortográfica todos los rayos comparten dirección, así que no se puede.
+  bool projectDirection(const glm::vec3& direction, glm::vec2& pixel) const {
+    return projection != Projection::Orthographic && project(direction, true, pixel);
+  }
+
+  // Rayos de `count` píxeles consecutivos de la fila y; los carriles sobrantes
+  // repiten el último rayo válido.
+  void packet(int x, int y, int count, RayPacket& packet, const glm::vec2& offset = glm::vec2(0.0f)) const {
+    packet.count = count;
+    for (int lane = 0; lane < PACKET_SIZE; lane++) {
+      int px = x + std::min(lane, count - 1);
+      packet.set(lane, origin(px, y, offset), direction(px, y, offset));
+    }
+  }
+
+  // Llama visit(packet, x, y) con los paquetes que cubren el rectángulo
+  // [x0, x1) x [y0, y1), fila por fila
+  template <typename Visit>
+  void tilePackets(int x0, int y0, int x1, int y1, Visit visit, const glm::vec2& offset = glm::vec2(0.0f)) const {
+    RayPacket rays;
+    for (int y = y0; y < y1; y++) {
+      for (int x = x0; x < x1; x += PACKET_SIZE) {
+        packet(x, y, std::min(PACKET_SIZE, x1 - x), rays, offset);
+        visit(rays, x, y);
+      }
+    }
+  }
+
+private:
+  bool project(const glm::vec3& offset, bool angular, glm::vec2& pixel) const {
+    float forward = glm::dot(offset, cameraDir);
+    glm::vec2 screen(glm::dot(offset, cameraX), glm::dot(offset, cameraY));
+    switch (projection) {
+      case Projection::Equirectangular: {
+        float length = glm::length(offset);
+        if (length == 0.0f) {
+          return false;
+        }
+        screen = glm::vec2(std::atan2(screen.x, forward), std::asin(std::clamp(screen.y / length, -1.0f, 1.0f)));
+        break;
+      }
+      default:
+        if (forward <= 0.0f) {
+          return false;
+        }
+        if (angular) {
+          screen /= forward;
+        }
+    }
+    pixel = screen / pixelStep + glm::vec2(width, height) * 0.5f;
+    return true;
+  }
+
+  void rebuildTables() {
+    columns.assign(width, glm::vec2(0.0f));
+    rows.assign(height, glm::vec2(0.0f));
+    float ratio = static_cast<float>(width) / static_cast<float>(height);
+    // Lo que avanza cada tabla por píxel (radianes en equirectangular)
+    switch (projection) {
+      case Projection::Orthographic:
+        pixelStep = glm::vec2(ratio * orthoHeight / width, -orthoHeight / height);
+        break;
+      case Projection::Equirectangular:
+        pixelStep = glm::vec2(2.0f * 3.14159265f / width, -3.14159265f / height);
+        break;
+      default:
+        pixelStep = glm::vec2(2.0f * ratio * tan(fov/2.0f) / width, -2.0f * tan(fov/2.0f) / height);
+    }
+
+    for (int x = 0; x < width; x++) {
+      float screenX = (2.0f * (x + 0.5f)) / width - 1.0f;
+      switch (projection) {
+        case Projection::Orthographic:
+          columns[x].x = screenX * ratio * orthoHeight * 0.5f;
+          break;
+        case Projection::Equirectangular: {
+          float longitude = screenX * 3.14159265f;
+          columns[x] = glm::vec2(std::cos(longitude), std::sin(longitude));
+          break;
+        }
+        default:
+          screenX *= ratio;
+          screenX *= tan(fov/2.0f);
+          columns[x].x = screenX;
+      }
+    }
+
+    for (int y = 0; y < height; y++) {
+      float screenY = -(2.0f * (y + 0.5f)) / height + 1.0f;
+      switch (projection) {
+        case Projection::Orthographic:
+          rows[y].x = screenY * orthoHeight * 0.5f;
+          break;
+        case Projection::Equirectangular: {
+          float latitude = screenY * 3.14159265f * 0.5f;
+          rows[y] = glm::vec2(std::cos(latitude), std::sin(latitude));
+          break;
+        }
+        default:
+          screenY *= tan(fov/2.0f);
+          rows[y].x = screenY;
+      }
+    }
+  }
+
+  int width = 0;
+  int height = 0;
+  Projection projection;
+  float fov;
+  float orthoHeight;
+
+  std::vector<glm::vec2> columns;
+  std::vector<glm::vec2> rows;
+  glm::vec2 pixelStep = glm::vec2(0.0f);
+
+  glm::vec3 position = glm::vec3(0.0f);
+  glm::vec3 cameraDir = glm::vec3(0.0f, 0.0f, -1.0f);
+  glm::vec3 cameraX = glm::vec3(1.0f, 0.0f, 0.0f);
+  glm::vec3 cameraY = glm::vec3(0.0f, 1.0f, 0.0f);
+};
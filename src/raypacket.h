@@ -0,0 +1,189 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <limits>
+#include "aabb.h"
+#include "intersect.h"
+#include "ray.h"
+#include "raybox.h"
+
+// Operaciones por carril para los paquetes de rayos: 8 carriles con AVX2,
+// 4 con SSE y un respaldo escalar de 4 carriles en otras arquitecturas.
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+constexpr int PACKET_SIZE = 8;
+using Lanes = __m256;
+
+inline Lanes lanesSet(float v) { return _mm256_set1_ps(v); }
+inline Lanes lanesLoad(const float* p) { return _mm256_load_ps(p); }
+inline Lanes lanesLoadUnaligned(const float* p) { return _mm256_loadu_ps(p); }
+inline void lanesStore(float* p, Lanes v) { _mm256_store_ps(p, v); }
+inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+inline Lanes lanesSub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+inline Lanes lanesMul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+inline Lanes lanesDiv(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+// Igual que glm::min/max: (b < a) ? b : a y (a < b) ? b : a
+inline Lanes lanesMin(Lanes a, Lanes b) { return _mm256_min_ps(b, a); }
+inline Lanes lanesMax(Lanes a, Lanes b) { return _mm256_max_ps(b, a); }
+inline Lanes lanesNotGreater(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_NGT_UQ); }
+inline Lanes lanesNotLess(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_NLT_UQ); }
+inline Lanes lanesLess(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+inline int lanesMask(Lanes v) { return _mm256_movemask_ps(v); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+constexpr int PACKET_SIZE = 4;
+using Lanes = __m128;
+
+inline Lanes lanesSet(float v) { return _mm_set1_ps(v); }
+inline Lanes lanesLoad(const float* p) { return _mm_load_ps(p); }
+inline Lanes lanesLoadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+inline void lanesStore(float* p, Lanes v) { _mm_store_ps(p, v); }
+inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes lanesSub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes lanesDiv(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+// Igual que glm::min/max: (b < a) ? b : a y (a < b) ? b : a
+inline Lanes lanesMin(Lanes a, Lanes b) { return _mm_min_ps(b, a); }
+inline Lanes lanesMax(Lanes a, Lanes b) { return _mm_max_ps(b, a); }
+inline Lanes lanesNotGreater(Lanes a, Lanes b) { return _mm_cmpngt_ps(a, b); }
+inline Lanes lanesNotLess(Lanes a, Lanes b) { return _mm_cmpnlt_ps(a, b); }
+inline Lanes lanesLess(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline int lanesMask(Lanes v) { return _mm_movemask_ps(v); }
+
+#else
+constexpr int PACKET_SIZE = 4;
+
+// Las comparaciones devuelven 1.0f/0.0f por carril
+struct Lanes {
+  float v[PACKET_SIZE];
+};
+
+#define SR1_LANES_OP(expr) Lanes r; for (int i = 0; i < PACKET_SIZE; i++) { r.v[i] = (expr); } return r;
+inline Lanes lanesSet(float x) { SR1_LANES_OP(x) }
+inline Lanes lanesLoad(const float* p) { SR1_LANES_OP(p[i]) }
+inline Lanes lanesLoadUnaligned(const float* p) { SR1_LANES_OP(p[i]) }
+inline void lanesStore(float* p, Lanes a) { for (int i = 0; i < PACKET_SIZE; i++) { p[i] = a.v[i]; } }
+inline Lanes lanesAdd(Lanes a, Lanes b) { SR1_LANES_OP(a.v[i] + b.v[i]) }
+inline Lanes lanesSub(Lanes a, Lanes b) { SR1_LANES_OP(a.v[i] - b.v[i]) }
+inline Lanes lanesMul(Lanes a, Lanes b) { SR1_LANES_OP(a.v[i] * b.v[i]) }
+inline Lanes lanesDiv(Lanes a, Lanes b) { SR1_LANES_OP(a.v[i] / b.v[i]) }
+inline Lanes lanesMin(Lanes a, Lanes b) { SR1_LANES_OP(glm::min(a.v[i], b.v[i])) }
+inline Lanes lanesMax(Lanes a, Lanes b) { SR1_LANES_OP(glm::max(a.v[i], b.v[i])) }
+inline Lanes lanesNotGreater(Lanes a, Lanes b) { SR1_LANES_OP(!(a.v[i] > b.v[i]) ? 1.0f : 0.0f) }
+inline Lanes lanesNotLess(Lanes a, Lanes b) { SR1_LANES_OP(!(a.v[i] < b.v[i]) ? 1.0f : 0.0f) }
+inline Lanes lanesLess(Lanes a, Lanes b) { SR1_LANES_OP(a.v[i] < b.v[i] ? 1.0f : 0.0f) }
+inline Lanes lanesAnd(Lanes a, Lanes b) { SR1_LANES_OP((a.v[i] != 0.0f && b.v[i] != 0.0f) ? 1.0f : 0.0f) }
+inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) { SR1_LANES_OP(mask.v[i] != 0.0f ? a.v[i] : b.v[i]) }
+inline int lanesMask(Lanes a) { int m = 0; for (int i = 0; i < PACKET_SIZE; i++) { m |= (a.v[i] != 0.0f) << i; } return m; }
+#undef SR1_LANES_OP
+#endif
+
+// Rayos de cámara coherentes trazados juntos, cada uno con su intervalo
+// [tMin, tMax] como Ray; solo los primeros `count` carriles son válidos.
+struct alignas(32) RayPacket {
+  float originX[PACKET_SIZE];
+  float originY[PACKET_SIZE];
+  float originZ[PACKET_SIZE];
+  float dirX[PACKET_SIZE];
+  float dirY[PACKET_SIZE];
+  float dirZ[PACKET_SIZE];
+  float invDirX[PACKET_SIZE];
+  float invDirY[PACKET_SIZE];
+  float invDirZ[PACKET_SIZE];
+  float tMin[PACKET_SIZE];
+  float tMax[PACKET_SIZE];
+  int count = 0;
+
+  void set(int lane, const glm::vec3& origin, const glm::vec3& direction, float laneTMin = 0.0f,
+           float laneTMax = std::numeric_limits<float>::infinity()) {
+    glm::vec3 invDir = safeInverse(direction);
+    originX[lane] = origin.x;
+    originY[lane] = origin.y;
+    originZ[lane] = origin.z;
+    dirX[lane] = direction.x;
+    dirY[lane] = direction.y;
+    dirZ[lane] = direction.z;
+    invDirX[lane] = invDir.x;
+    invDirY[lane] = invDir.y;
+    invDirZ[lane] = invDir.z;
+    tMin[lane] = laneTMin;
+    tMax[lane] = laneTMax;
+  }
+
+  void set(int lane, const Ray& ray) {
+    set(lane, ray.origin, ray.direction, ray.tMin, ray.tMax);
+  }
+
+  glm::vec3 origin(int lane) const {
+    return glm::vec3(originX[lane], originY[lane], originZ[lane]);
+  }
+
+  glm::vec3 direction(int lane) const {
+    return glm::vec3(dirX[lane], dirY[lane], dirZ[lane]);
+  }
+
+  Ray ray(int lane) const {
+    return Ray(origin(lane), direction(lane), tMin[lane], tMax[lane]);
+  }
+
+  int activeMask() const {
+    return (1 << count) - 1;
+  }
+};
+
+// Hit de cada carril en SoA: primitivo más cercano (-1 si no hay impacto) y su cara
+struct alignas(32) PacketHit {
+  float dist[PACKET_SIZE];
+  int ids[PACKET_SIZE];
+  int faces[PACKET_SIZE];
+
+  Hit get(int lane) const {
+    return Hit{dist[lane], ids[lane], faces[lane]};
+  }
+
+  void set(int lane, const Hit& hit) {
+    dist[lane] = hit.dist;
+    ids[lane] = hit.primitive;
+    faces[lane] = hit.face;
+  }
+};
+
+// Paquete cargado en registros
+struct PacketLanes {
+  Lanes originX, originY, originZ;
+  Lanes invDirX, invDirY, invDirZ;
+  Lanes tMin, tMax;
+
+  explicit PacketLanes(const RayPacket& packet)
+    : originX(lanesLoad(packet.originX)), originY(lanesLoad(packet.originY)), originZ(lanesLoad(packet.originZ)),
+      invDirX(lanesLoad(packet.invDirX)), invDirY(lanesLoad(packet.invDirY)), invDirZ(lanesLoad(packet.invDirZ)),
+      tMin(lanesLoad(packet.tMin)), tMax(lanesLoad(packet.tMax)) {}
+
+  // Slab test de todo el paquete contra una caja, con la misma aritmética que
+  // rayBox. Devuelve la máscara de carriles cuyo tramo [tMin, tMax] cruza la
+  // caja y en `dist` la distancia de impacto (tFar si la caja empieza antes de
+  // tMin). Como AABB::intersect, no descarta cajas con dist > tMax si el
+  // tramo empieza adentro: eso lo decide el llamador (los nodos sí cuentan).
+  int intersect(const AABB& box, Lanes& tNear, Lanes& dist) const {
+    Lanes t1x = lanesMul(lanesSub(lanesSet(box.min.x), originX), invDirX);
+    Lanes t1y = lanesMul(lanesSub(lanesSet(box.min.y), originY), invDirY);
+    Lanes t1z = lanesMul(lanesSub(lanesSet(box.min.z), originZ), invDirZ);
+    Lanes t2x = lanesMul(lanesSub(lanesSet(box.max.x), originX), invDirX);
+    Lanes t2y = lanesMul(lanesSub(lanesSet(box.max.y), originY), invDirY);
+    Lanes t2z = lanesMul(lanesSub(lanesSet(box.max.z), originZ), invDirZ);
+
+    tNear = lanesMax(lanesMax(lanesMin(t1x, t2x), lanesMin(t1y, t2y)), lanesMin(t1z, t2z));
+    Lanes tFar = lanesMin(lanesMin(lanesMax(t1x, t2x), lanesMax(t1y, t2y)), lanesMax(t1z, t2z));
+
+    dist = lanesSelect(lanesLess(tNear, tMin), tFar, tNear);
+    Lanes tFarLimit = lanesMul(tFar, lanesSet(SLAB_TOLERANCE));
+    Lanes inInterval = lanesAnd(lanesNotLess(tFar, tMin), lanesNotGreater(tNear, tMax));
+    return lanesMask(lanesAnd(lanesNotGreater(tNear, tFarLimit), inInterval));
+  }
+};
@@ -0,0 +1,376 @@
+#include "renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "globals.h"
+#include "skybox.h"
+#include "timeline.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanoseconds(Clock::duration duration) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+} // namespace
+
+Renderer::Renderer(int width, int height)
+    : rayGenerator(width, height), progressive(width, height), reprojection(width, height),
+      width(width), height(height), hdrFrame(width, height) {}
+
+void Renderer::start(unsigned threads) {
+    scene.shrinkToFit();
+    pool = std::make_unique<ThreadPool>(threads);
+    ensureBuilt(acceleratorIndex());
+}
+
+void Renderer::ensureBuilt(int index) {
+    if (!pool || built[index]) {
+        return;
+    }
+    {
+        StartupTimeline::Scope timing(std::string("construir ") + accelerators[index]->name());
+        accelerators[index]->build(scene, *pool);
+    }
+    buildStats[index] = accelerators[index]->buildInfo();
+    built[index] = true;
+}
+
+void Renderer::restoreBvh(std::vector<BVHNode> nodes, std::vector<int> primitiveIds) {
+    StartupTimeline::Scope timing("restaurar BVH de la caché");
+    bvh.restore(scene, std::move(nodes), std::move(primitiveIds));
+    buildStats[1] = bvh.buildInfo();
+    built[1] = true;
+    bvhRestored = true;
+}
+
+const BVH& Renderer::builtBvh() {
+    ensureBuilt(1);
+    return bvh;
+}
+
+void Renderer::reportBuild(std::ostream& out) const {
+    int primitives = std::max(scene.size(), 1);
+    out << "Escena: " << scene.size() << " primitivos, " << scene.memoryBytes() / primitives << " bytes por primitivo" << std::endl;
+    for (int i = 0; i < 3; i++) {
+        if (!built[i]) {
+            continue;
+        }
+        out << accelerators[i]->name() << ": " << buildStats[i].nodeCount << " nodos, " << buildStats[i].bytes / primitives
+            << " bytes por primitivo, " << (i == 1 && bvhRestored ? "cargado de la caché en " : "construido en ")
+            << buildStats[i].buildMs << " ms" << std::endl;
+    }
+}
+
+int Renderer::acceleratorIndex() const {
+    return static_cast<int>(std::find(accelerators, accelerators + 3, accelerator) - accelerators);
+}
+
+void Renderer::setAccelerator(const std::string& name) {
+    if (name == "brute") {
+        accelerator = &bruteForce;
+    } else if (name == "grid") {
+        accelerator = &voxelGrid;
+    } else {
+        accelerator = &bvh;
+    }
+    ensureBuilt(acceleratorIndex());
+}
+
+void Renderer::selectAccelerator(int index) {
+    accelerator = accelerators[std::clamp(index, 0, 2)];
+    ensureBuilt(acceleratorIndex());
+}
+
+float Renderer::castShadow(const glm::vec3& shadowOrigin, const glm::vec3& lightDir, int hitId) const {
+    float lightDistance = glm::length(light.position - shadowOrigin);
+    float shadowDist;
+    SR1_COUNT(SHADOW_RAYS, 1);
+    if (accelerator->occluded(Ray(shadowOrigin, lightDir, 0.0f, lightDistance), hitId, shadowDist)) {
+        float shadowRatio = shadowDist / lightDistance;
+        shadowRatio = glm::min(1.0f, shadowRatio);
+        return 1.0f - shadowRatio;
+    }
+    return 1.0f;
+}
+
+// Color del punto ya encontrado por el rayo; los rayos secundarios salen de aquí
+Radiance Renderer::shade(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const Intersect& intersect, int hitId, const short recursion) const {
+    SR1_COUNT(DEPTH_0 + recursion, 1);
+    if (!intersect.isIntersecting || recursion == MAX_RECURSION) {
+        SR1_COUNT(SKYBOX_RAYS, 1);
+        // Los rayos reflejados y refractados usan el cielo prefiltrado
+        return (recursion > 0) ? Skybox::getReflectionColor(rayDirection) : Skybox::getColor(rayDirection);
+    }
+
+
+    glm::vec3 lightDir = glm::normalize(light.position - intersect.point);
+    glm::vec3 viewDir = glm::normalize(rayOrigin - intersect.point);
+    glm::vec3 reflectDir = glm::reflect(-glm::normalize(rayOrigin), intersect.normal);
+    
+
+    float shadowIntensity = castShadow(intersect.point, lightDir, hitId);
+
+    float diffuseLightIntensity = std::max(0.0f, glm::dot(intersect.normal, lightDir));
+    float specReflection = glm::dot(viewDir, reflectDir);
+    
+    const Material& mat = scene.material(hitId);
+
+    float specLightIntensity = std::pow(std::max(0.0f, glm::dot(viewDir, reflectDir)), mat.specularCoefficient);
+
+
+    Radiance reflectedColor(0.0f);
+    if (mat.reflectivity > 0) {
+        glm::vec3 origin = intersect.point + intersect.normal * BIAS;
+        SR1_COUNT(REFLECT_RAYS, 1);
+        reflectedColor = castRay(origin, reflectDir, recursion + 1, hitId); 
+    }
+
+    Radiance refractedColor(0.0f);
+    if (mat.transparency > 0) {
+        glm::vec3 origin = intersect.point - intersect.normal * BIAS;
+        glm::vec3 refractDir = glm::refract(rayDirection, intersect.normal, mat.refractionIndex);
+        SR1_COUNT(REFRACT_RAYS, 1);
+        refractedColor = castRay(origin, refractDir, recursion + 1, hitId); 
+    }
+
+    Radiance materialLight = intersect.hasColor ? intersect.color : mat.diffuse;
+
+    Radiance diffuseLight = materialLight * light.intensity * diffuseLightIntensity * mat.albedo * shadowIntensity;
+    Radiance specularLight = light.color * light.intensity * specLightIntensity * mat.specularAlbedo * shadowIntensity;
+    Radiance color = (diffuseLight + specularLight) * (1.0f - mat.reflectivity - mat.transparency) + reflectedColor * mat.reflectivity + refractedColor * mat.transparency;
+    return color;
+}
+
+Radiance Renderer::castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion, int currentObj) const {
+    if (recursion == 0) {
+        SR1_COUNT(PRIMARY_RAYS, 1);
+    }
+    Ray ray(rayOrigin, rayDirection);
+    Hit hit = accelerator->closestHit(ray, currentObj);
+    Intersect intersect;
+    if (hit.primitive >= 0) {
+        intersect = scene.surface(hit, ray);
+    }
+    return shade(rayOrigin, rayDirection, intersect, hit.primitive, recursion);
+}
+
+// Rayo primario de un píxel; guarda el impacto para reproyectarlo en el cuadro
+// siguiente y, si se pasa `hits`, para el antialiasing adaptativo
+Radiance Renderer::tracePixel(int x, int y, const glm::vec2& jitter, AdaptiveSampler::Tile* hits) {
+    Ray ray(rayGenerator.origin(x, y, jitter), rayGenerator.direction(x, y, jitter));
+    SR1_COUNT(PRIMARY_RAYS, 1);
+    Hit hit = accelerator->closestHit(ray, -1);
+    Intersect intersect;
+    if (hit.primitive >= 0) {
+        intersect = scene.surface(hit, ray);
+    }
+    Radiance color = shade(ray.origin, ray.direction, intersect, hit.primitive, 0);
+    reprojection.record(x, y, hit.primitive, hit.primitive >= 0 ? intersect.point : ray.direction, intersect.normal, color);
+    if (hits) {
+        hits->record(x, y, hit.primitive, hit.face);
+    }
+    return color;
+}
+
+// Un rayo por píxel en [x0, x1) x [y0, y1), desplazado `jitter` dentro del píxel
+void Renderer::traceRect(int x0, int y0, int x1, int y1, const glm::vec2& jitter, AdaptiveSampler::Tile* hits) {
+    if (!usePackets) {
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                hdrFrame.at(x, y) = tracePixel(x, y, jitter, hits);
+            }
+        }
+        return;
+    }
+
+    // Los rayos primarios van en paquetes de PACKET_SIZE píxeles de una fila;
+    // el sombreado y los rayos secundarios siguen siendo de a uno
+    PacketHit hit;
+    rayGenerator.tilePackets(x0, y0, x1, y1, [&](const RayPacket& packet, int x, int y) {
+        accelerator->closestHitPacket(packet, hit);
+        SR1_COUNT(PRIMARY_RAYS, packet.count);
+
+        for (int lane = 0; lane < packet.count; lane++) {
+            glm::vec3 rayOrigin = packet.origin(lane);
+            glm::vec3 rayDirection = packet.direction(lane);
+            Intersect intersect;
+            if (hit.ids[lane] >= 0) {
+                intersect = scene.surface(hit.get(lane), packet.ray(lane));
+            }
+            Radiance color = shade(rayOrigin, rayDirection, intersect, hit.ids[lane], 0);
+            reprojection.record(x + lane, y, hit.ids[lane], hit.ids[lane] >= 0 ? intersect.point : rayDirection,
+                                intersect.normal, color);
+            if (hits) {
+                hits->record(x + lane, y, hit.ids[lane], hit.faces[lane]);
+            }
+            hdrFrame.at(x + lane, y) = color;
+        }
+    }, jitter);
+}
+
+// Un rayo por píxel y, donde hay bordes o contraste, muestras extra dentro del
+// presupuesto de antialiasing. Sin acumulación entre cuadros es lo que suaviza
+// los bordes.
+void Renderer::traceAntialiased(int x0, int y0, int x1, int y1) {
+    if (!adaptive.isEnabled()) {
+        traceRect(x0, y0, x1, y1, glm::vec2(0.0f));
+        return;
+    }
+    AdaptiveSampler::Tile hits(x0, y0, x1, y1);
+    traceRect(x0, y0, x1, y1, glm::vec2(0.0f), &hits);
+    adaptive.refine(hdrFrame, hits, [this](int x, int y, const glm::vec2& offset) {
+        return castRay(rayGenerator.origin(x, y, offset), rayGenerator.direction(x, y, offset));
+    });
+    // La historia guarda el color suavizado, para que reutilizarlo no vuelva a dentar los bordes
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            reprojection.updateColor(x, y, hdrFrame.at(x, y));
+        }
+    }
+}
+
+// Reutiliza los píxeles del cuadro anterior que pasan la validación y traza el
+// resto. Si quedan más de la mitad por trazar, se traza el tile entero en paquetes.
+void Renderer::traceReprojected(int x0, int y0, int x1, int y1) {
+    bool reusable[TILE_SIZE][TILE_SIZE];
+    int reused = 0;
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            reusable[y - y0][x - x0] = reprojection.reusable(x, y, rayGenerator.direction(x, y), scene);
+            reused += reusable[y - y0][x - x0];
+        }
+    }
+    if (2 * reused < (x1 - x0) * (y1 - y0)) {
+        traceAntialiased(x0, y0, x1, y1);
+        return;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            hdrFrame.at(x, y) = reusable[y - y0][x - x0] ? reprojection.reuse(x, y) : tracePixel(x, y, glm::vec2(0.0f));
+        }
+    }
+    reprojection.countReused(reused);
+}
+
+// Vista previa: un rayo por bloque de scale x scale píxeles, copiado a todo el bloque
+void Renderer::tracePreview(int x0, int y0, int x1, int y1, int scale) {
+    for (int by = y0; by < y1; by += scale) {
+        for (int bx = x0; bx < x1; bx += scale) {
+            int ex = std::min(bx + scale, x1);
+            int ey = std::min(by + scale, y1);
+            int cx = (bx + ex) / 2;
+            int cy = (by + ey) / 2;
+            Radiance color = castRay(rayGenerator.origin(cx, cy), rayGenerator.direction(cx, cy));
+            for (int y = by; y < ey; y++) {
+                for (int x = bx; x < ex; x++) {
+                    hdrFrame.at(x, y) = color;
+                }
+            }
+        }
+    }
+}
+
+void Renderer::renderTile(Framebuffer& target, int tile) {
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int x0 = (tile % tilesX) * TILE_SIZE;
+    const int y0 = (tile / tilesX) * TILE_SIZE;
+    const int x1 = std::min(x0 + TILE_SIZE, width);
+    const int y1 = std::min(y0 + TILE_SIZE, height);
+    auto start = Clock::now();
+
+    if (pass.mode == ProgressivePass::Preview) {
+        tracePreview(x0, y0, x1, y1, pass.scale);
+    } else if (pass.mode == ProgressivePass::Reproject) {
+        traceReprojected(x0, y0, x1, y1);
+    } else if (pass.mode == ProgressivePass::Full) {
+        traceAntialiased(x0, y0, x1, y1);
+    } else {
+        traceRect(x0, y0, x1, y1, pass.jitter);
+        if (pass.mode == ProgressivePass::Refine) {
+            progressive.accumulate(hdrFrame, x0, y0, x1, y1);
+        }
+    }
+
+    auto traced = Clock::now();
+    // Se cuantiza una sola vez, con el tile todavía en caché
+    tonemapper.resolve(hdrFrame, target, x0, y0, x1, y1);
+
+    traceNs.fetch_add(nanoseconds(traced - start), std::memory_order_relaxed);
+    tonemapNs.fetch_add(nanoseconds(Clock::now() - traced), std::memory_order_relaxed);
+}
+
+void Renderer::beginFrame(const Camera& camera, Framebuffer& target) {
+    rayGenerator.update(camera);
+    pass = progressive.beginFrame(camera);
+    // En movimiento, si hay un cuadro completo anterior, se reproyecta en vez
+    // de trazar la vista previa
+    if (reprojection.hasHistory() && (pass.mode == ProgressivePass::Preview || pass.mode == ProgressivePass::Full)) {
+        pass = ProgressivePass{ProgressivePass::Reproject};
+        auto start = Clock::now();
+        reprojection.reproject(rayGenerator);
+        reprojectNs.fetch_add(nanoseconds(Clock::now() - start), std::memory_order_relaxed);
+    }
+    if (progressive.converged()) {
+        return;
+    }
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    for (int tile = 0; tile < tilesX * tilesY; tile++) {
+        pool->submit([this, &target, tile] { renderTile(target, tile); });
+    }
+}
+
+bool Renderer::endFrame() {
+    pool->wait();
+    if (progressive.converged()) {
+        return false;
+    }
+    progressive.endFrame();
+    if (pass.mode != ProgressivePass::Preview) {
+        reprojection.endFrame(pass.mode == ProgressivePass::Reproject);
+    }
+    return true;
+}
+
+Renderer::FrameStats Renderer::collectFrameStats() {
+    FrameStats stats;
+    stats.counters = Counters::collect();
+    stats.reprojectMs = reprojectNs.exchange(0, std::memory_order_relaxed) / 1e6;
+    stats.traceMs = traceNs.exchange(0, std::memory_order_relaxed) / 1e6;
+    stats.tonemapMs = tonemapNs.exchange(0, std::memory_order_relaxed) / 1e6;
+    return stats;
+}
+
+void Renderer::report(std::ostream& out) {
+    Accelerator::Stats frameStats = accelerator->collectStats();
+    if (frameStats.rays > 0) {
+        out << accelerator->name() << ": " << static_cast<double>(frameStats.steps) / frameStats.rays << " pasos de recorrido por rayo" << std::endl;
+    }
+    uint64_t closestRays = frameStats.packetRays + frameStats.singleRays;
+    if (closestRays > 0) {
+        out << "Paquetes: " << 100.0 * frameStats.packetRays / closestRays << "% de los rayos";
+        if (frameStats.packetNs > 0) {
+            out << ", " << frameStats.packetRays * 1e9 / frameStats.packetNs << " rayos/s";
+        }
+        out << " | Individuales: " << 100.0 * frameStats.singleRays / closestRays << "%";
+        if (frameStats.singleNs > 0) {
+            out << ", " << frameStats.singleRays * 1e9 / frameStats.singleNs << " rayos/s";
+        }
+        out << std::endl;
+    }
+    int reprojectedFrames;
+    double reuseRatio = reprojection.collectReuseRatio(reprojectedFrames);
+    if (reprojectedFrames > 0) {
+        out << "Reproyección: " << 100.0 * reuseRatio << "% de píxeles reutilizados en " << reprojectedFrames
+            << " cuadros (último: " << 100.0 * reprojection.lastReuseRatio() << "%)" << std::endl;
+    }
+    double samplesPerPixel = adaptive.collectAverageSamples();
+    if (samplesPerPixel > 0.0) {
+        out << "Antialiasing: " << samplesPerPixel << " muestras por píxel en promedio" << std::endl;
+    }
+}
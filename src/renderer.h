@@ -0,0 +1,159 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "accelerator.h"
+#include "adaptive.h"
+#include "bvh.h"
+#include "camera.h"
+#include "counters.h"
+#include "framebuffer.h"
+#include "intersect.h"
+#include "light.h"
+#include "progressive.h"
+#include "radiance.h"
+#include "raygenerator.h"
+#include "reprojection.h"
+#include "scene.h"
+#include "threadpool.h"
+#include "tonemap.h"
+#include "voxelgrid.h"
+
+// Núcleo del trazador: escena, aceleradores, rayos primarios y las pasadas de
+// cada cuadro, sin ventana ni eventos. Lo usan igual el modo interactivo y el
+// modo sin pantalla; no depende de SDL.
+class Renderer {
+public:
+  // Contadores y tiempo de cada etapa desde la última llamada a
+  // collectFrameStats(). Los tiempos de los tiles se suman entre hilos.
+  struct FrameStats {
+    Counters::Totals counters;    // en cero si se compiló con SR1_STATS=0
+    double reprojectMs = 0.0;     // proyección de la historia, antes de encolar los tiles
+    double traceMs = 0.0;         // trazado y sombreado de los tiles
+    double tonemapMs = 0.0;       // tonemap de los tiles
+  };
+
+  Renderer(int width, int height);
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+  // Crea los hilos y construye el acelerador elegido; llamar con la escena ya
+  // armada. Los otros se construyen recién cuando se eligen.
+  void start(unsigned threads);
+
+  // Adopta un BVH ya construido para la escena actual (de la caché de escena);
+  // llamar antes de start()
+  void restoreBvh(std::vector<BVHNode> nodes, std::vector<int> primitiveIds);
+
+  // El BVH de la escena, construyéndolo si todavía no se hizo; llamar después de start()
+  const BVH& builtBvh();
+
+  // Escribe lo que tardó en construirse cada acelerador ya construido
+  void reportBuild(std::ostream& out) const;
+
+  const char* acceleratorName() const {
+    return accelerator->name();
+  }
+
+  double acceleratorBuildMs() const {
+    return buildStats[acceleratorIndex()].buildMs;
+  }
+
+  // Memoria del acelerador actual, sin la tabla de la escena
+  size_t acceleratorBytes() const {
+    return buildStats[acceleratorIndex()].bytes;
+  }
+
+  // "brute", "bvh" o "grid"; cualquier otro nombre elige el BVH
+  void setAccelerator(const std::string& name);
+
+  // 0: fuerza bruta, 1: BVH, 2: grilla
+  void selectAccelerator(int index);
+
+  void setUsePackets(bool value) {
+    usePackets = value;
+  }
+
+  bool getUsePackets() const {
+    return usePackets;
+  }
+
+  // Decide la pasada del cuadro para `camera` y encola sus tiles sobre `target`
+  // sin esperar; con la imagen convergida no encola nada
+  void beginFrame(const Camera& camera, Framebuffer& target);
+
+  // Espera los tiles del cuadro y lo cierra. Devuelve false si no se trazó nada
+  // porque la imagen ya había convergido.
+  bool endFrame();
+
+  bool converged() const {
+    return progressive.converged();
+  }
+
+  const ProgressivePass& currentPass() const {
+    return pass;
+  }
+
+  // Radiancia del último cuadro, antes del tonemap
+  const HdrFramebuffer& radiance() const {
+    return hdrFrame;
+  }
+
+  FrameStats collectFrameStats();
+
+  // Escribe las estadísticas acumuladas desde la última llamada y las reinicia
+  void report(std::ostream& out);
+
+  Scene scene;
+  Light light = {glm::vec3(-10.0f, 10.0f, 20.0f), 1.0f, Radiance(1.0f)};
+  RayGenerator rayGenerator;
+  Tonemapper tonemapper;
+  Progressive progressive;
+  Reprojection reprojection;
+  AdaptiveSampler adaptive;
+
+private:
+  float castShadow(const glm::vec3& shadowOrigin, const glm::vec3& lightDir, int hitId) const;
+  Radiance castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion = 0, int currentObj = -1) const;
+  Radiance shade(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const Intersect& intersect, int hitId, const short recursion) const;
+
+  Radiance tracePixel(int x, int y, const glm::vec2& jitter, AdaptiveSampler::Tile* hits = nullptr);
+  void traceRect(int x0, int y0, int x1, int y1, const glm::vec2& jitter, AdaptiveSampler::Tile* hits = nullptr);
+  void traceAntialiased(int x0, int y0, int x1, int y1);
+  void traceReprojected(int x0, int y0, int x1, int y1);
+  void tracePreview(int x0, int y0, int x1, int y1, int scale);
+  void renderTile(Framebuffer& target, int tile);
+  int acceleratorIndex() const;
+  void ensureBuilt(int index);
+
+  int width;
+  int height;
+  std::unique_ptr<ThreadPool> pool;
+  // Radiancia del cuadro en curso; cada tile pasa la suya por el tonemap al terminar
+  HdrFramebuffer hdrFrame;
+  ProgressivePass pass;
+  bool usePackets = true;
+
+  BruteForce bruteForce;
+  BVH bvh;
+  VoxelGrid voxelGrid;
+  Accelerator* accelerators[3] = {&bruteForce, &bvh, &voxelGrid};
+  Accelerator* accelerator = &bvh;
+  Accelerator::Stats buildStats[3];
+  bool built[3] = {};
+  bool bvhRestored = false;
+
+  std::atomic<uint64_t> reprojectNs{0};
+  std::atomic<uint64_t> traceNs{0};
+  std::atomic<uint64_t> tonemapNs{0};
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "radiance.h"
+#include "raygenerator.h"
+#include "scene.h"
+
+// Reuso temporal de los rayos primarios. Cada píxel trazado guarda su punto de
+// impacto en el mundo (o la dirección, si vio el cielo), normal, primitivo y
+// color. Con la cámara nueva esos puntos se proyectan a la imagen (gana el más
+// cercano) y un píxel reutiliza el color que le cayó si pasa la validación;
+// los demás se vuelven a trazar. La escena es estática, así que la historia
+// sirve aunque haya pasado más de un cuadro.
+class Reprojection {
+public:
+  // Cuadros seguidos que se puede reutilizar una muestra antes de retrazarla,
+  // para que el brillo especular y el error de proyección no se acumulen
+  static constexpr int MAX_AGE = 8;
+  // Un vecino más cercano que esto (relativo) con otro primitivo indica que la
+  // muestra se ve a través de un hueco del objeto de adelante
+  static constexpr float DEPTH_TOLERANCE = 0.05f;
+  // Superficies casi de canto: su proyección es poco confiable
+  static constexpr float MIN_FACING = 0.1f;
+
+  Reprojection(int width, int height)
+    : width(width), height(height), history(width * height), current(width * height),
+      candidates(width * height, -1), candidateDepth(width * height) {}
+
+  void setEnabled(bool value) {
+    enabled = value;
+    historyValid = false;
+  }
+
+  bool isEnabled() const {
+    return enabled;
+  }
+
+  // ¿Hay un cuadro completo trazado desde el que reproyectar?
+  bool hasHistory() const {
+    return enabled && historyValid;
+  }
+
+  // Proyecta la historia en la cámara de `rays` (ya actualizado); llamar antes
+  // de renderizar un cuadro que reutiliza
+  void reproject(const RayGenerator& rays) {
+    std::fill(candidates.begin(), candidates.end(), -1);
+    std::fill(candidateDepth.begin(), candidateDepth.end(), std::numeric_limits<float>::infinity());
+    const glm::vec3& cameraPosition = rays.getPosition();
+
+    for (int i = 0; i < width * height; i++) {
+      const Sample& sample = history[i];
+      glm::vec2 pixel;
+      float depth;
+      if (sample.primitive >= 0) {
+        if (!rays.projectPoint(sample.point, pixel)) {
+          continue;
+        }
+        depth = glm::length(sample.point - cameraPosition);
+      } else {
+        if (!rays.projectDirection(sample.point, pixel)) {
+          continue;
+        }
+        depth = std::numeric_limits<float>::max();
+      }
+
+      int x = static_cast<int>(std::floor(pixel.x));
+      int y = static_cast<int>(std::floor(pixel.y));
+      if (x < 0 || x >= width || y < 0 || y >= height) {
+        continue;
+      }
+      int target = y * width + x;
+      if (depth < candidateDepth[target]) {
+        candidateDepth[target] = depth;
+        candidates[target] = i;
+      }
+    }
+  }
+
+  // ¿Se puede reutilizar lo que cayó en el píxel? Necesita una muestra joven,
+  // de un material sin reflexión ni refracción (su color depende del punto de
+  // vista), una superficie que no esté de canto y ningún vecino claramente más
+  // cercano de otro primitivo. Los bordes de los objetos se retrazan siempre.
+  bool reusable(int x, int y, const glm::vec3& viewDirection, const Scene& scene) const {
+    int target = y * width + x;
+    int index = candidates[target];
+    if (index < 0) {
+      return false;
+    }
+    const Sample& sample = history[index];
+    if (sample.age >= MAX_AGE) {
+      return false;
+    }
+    if (sample.primitive >= 0) {
+      const Material& material = scene.material(sample.primitive);
+      if (material.reflectivity > 0.0f || material.transparency > 0.0f) {
+        return false;
+      }
+      if (std::abs(glm::dot(sample.normal, viewDirection)) < MIN_FACING) {
+        return false;
+      }
+    }
+
+    const int neighbors[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto& offset : neighbors) {
+      int nx = x + offset[0];
+      int ny = y + offset[1];
+      if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+        continue;
+      }
+      int neighbor = candidates[ny * width + nx];
+      if (neighbor >= 0 && history[neighbor].primitive != sample.primitive &&
+          candidateDepth[ny * width + nx] < candidateDepth[target] * (1.0f - DEPTH_TOLERANCE)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Copia la muestra reutilizada al cuadro actual y devuelve su color
+  Radiance reuse(int x, int y) {
+    int target = y * width + x;
+    Sample sample = history[candidates[target]];
+    sample.age++;
+    current[target] = sample;
+    return sample.color;
+  }
+
+  // Guarda la muestra recién trazada del píxel; `point` es la dirección del
+  // rayo si no hubo impacto (primitive < 0)
+  void record(int x, int y, int primitive, const glm::vec3& point, const glm::vec3& normal, const Radiance& color) {
+    if (enabled) {
+      current[y * width + x] = Sample{color, point, normal, primitive, 0};
+    }
+  }
+
+  // Reemplaza el color de la muestra ya guardada del píxel (p. ej. tras el antialiasing)
+  void updateColor(int x, int y, const Radiance& color) {
+    if (enabled) {
+      current[y * width + x].color = color;
+    }
+  }
+
+  void countReused(uint64_t pixels) {
+    reusedPixels.fetch_add(pixels, std::memory_order_relaxed);
+  }
+
+  // El cuadro terminó con todos sus píxeles guardados: pasa a ser la historia.
+  // `reprojected` indica si el cuadro reutilizó, para las estadísticas.
+  void endFrame(bool reprojected) {
+    if (!enabled) {
+      return;
+    }
+    std::swap(history, current);
+    historyValid = true;
+    if (reprojected) {
+      uint64_t reused = reusedPixels.exchange(0, std::memory_order_relaxed);
+      lastRatio = static_cast<double>(reused) / (static_cast<double>(width) * height);
+      ratioSum += lastRatio;
+      frames++;
+    }
+  }
+
+  // Fracción de píxeles reutilizados en el último cuadro reproyectado
+  double lastReuseRatio() const {
+    return lastRatio;
+  }
+
+  // Promedio de la fracción reutilizada y cuadros reproyectados desde la última llamada
+  double collectReuseRatio(int& frameCount) {
+    frameCount = frames;
+    double average = frames > 0 ? ratioSum / frames : 0.0;
+    ratioSum = 0.0;
+    frames = 0;
+    return average;
+  }
+
+private:
+  struct Sample {
+    Radiance color = Radiance(0.0f);
+    glm::vec3 point = glm::vec3(0.0f); // dirección del rayo si primitive < 0
+    glm::vec3 normal = glm::vec3(0.0f);
+    int primitive = -1;
+    int age = MAX_AGE;                 // las muestras sin trazar no se reutilizan
+  };
+
+  int width;
+  int height;
+  bool enabled = true;
+  bool historyValid = false;
+
+  std::vector<Sample> history;  // el último cuadro completo
+  std::vector<Sample> current;  // el cuadro en curso
+  std::vector<int> candidates;  // índice en history que cayó en cada píxel, o -1
+  std::vector<float> candidateDepth;
+
+  std::atomic<uint64_t> reusedPixels{0};
+  double lastRatio = 0.0;
+  double ratioSum = 0.0;
+  int frames = 0;
+};
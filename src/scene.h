@@ -0,0 +1,168 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "aabb.h"
+#include "block.h"
+#include "boxsoa.h"
+#include "cube.h"
+#include "intersect.h"
+#include "material.h"
+#include "object.h"
+#include "ray.h"
+#include "raybox.h"
+
+// Objetos de la escena identificados por un índice de primitivo. Los bloques
+// se guardan como caja + tipo de bloque en una tabla SoA contigua y se prueban
+// sin llamadas virtuales; el resto de objetos queda en `objects` y usa la
+// interfaz de Object. Los bloques tienen ids 0..blockCount()-1 en orden de
+// inserción y los demás objetos van después.
+class Scene {
+public:
+  BlockId addBlockType(const BlockType& type) {
+    blockTypes.push_back(type);
+    return static_cast<BlockId>(blockTypes.size() - 1);
+  }
+
+  // Tipo de bloque por nombre; lanza si no existe
+  BlockId findBlockType(const std::string& name) const {
+    for (size_t i = 0; i < blockTypes.size(); i++) {
+      if (blockTypes[i].name == name) {
+        return static_cast<BlockId>(i);
+      }
+    }
+    throw std::runtime_error("Block type not found: " + name);
+  }
+
+  const BlockType& blockType(BlockId type) const {
+    return blockTypes[type];
+  }
+
+  void addBlock(const glm::vec3& minBound, const glm::vec3& maxBound, BlockId type) {
+    blocks.push(AABB{glm::min(minBound, maxBound), glm::max(minBound, maxBound)}, blocks.size());
+    blockIds.push_back(type);
+  }
+
+  // Agrega `count` bloques de una vez, con las cajas por columnas
+  void addBlocks(int count, const float* const columns[6], const BlockId* types) {
+    blocks.append(count, columns, blocks.size());
+    blockIds.insert(blockIds.end(), types, types + count);
+  }
+
+  // Objetos que no son bloques, probados con la interfaz virtual
+  void add(std::unique_ptr<Object> object) {
+    objects.push_back(std::move(object));
+  }
+
+  // Suelta las tablas; la de bloques es una sola reserva
+  void clear() {
+    blocks.clear();
+    blockIds.clear();
+    blockTypes.clear();
+    objects.clear();
+  }
+
+  int size() const {
+    return blockCount() + static_cast<int>(objects.size());
+  }
+
+  // Ajusta las tablas a los primitivos que hay. Renderer::start lo llama antes
+  // de construir, así la disposición no depende de cómo se armó la escena.
+  void shrinkToFit() {
+    blocks.shrinkToFit();
+    blockIds.shrink_to_fit();
+  }
+
+  // Bytes reservados por las tablas de la escena; de los objetos que no son
+  // bloques solo cuenta el puntero
+  size_t memoryBytes() const {
+    return blocks.bytes() + blockIds.capacity() * sizeof(BlockId) + blockTypes.capacity() * sizeof(BlockType) +
+           objects.capacity() * sizeof(std::unique_ptr<Object>);
+  }
+
+  int blockCount() const {
+    return blocks.size();
+  }
+
+  bool isBlock(int id) const {
+    return id < blockCount();
+  }
+
+  // Tabla de bloques: blockBoxes().ids[i] == i
+  const BoxSoA& blockBoxes() const {
+    return blocks;
+  }
+
+  BlockId blockId(int id) const {
+    return blockIds[id];
+  }
+
+  const Object& object(int id) const {
+    return *objects[id - blockCount()];
+  }
+
+  AABB bounds(int id) const {
+    return isBlock(id) ? blocks.box(id) : object(id).bounds();
+  }
+
+  const Material& material(int id) const {
+    return isBlock(id) ? blockTypes[blockIds[id]].material : object(id).material;
+  }
+
+  // Cara del primitivo `id` por la que entra el rayo, al cerrar el paso geométrico
+  int face(int id, const Ray& ray) const {
+    if (!isBlock(id)) {
+      return FACE_NONE;
+    }
+    BoxHit hit;
+    if (!rayBox(blockMin(id), blockMax(id), ray, hit)) {
+      return FACE_NONE;
+    }
+    return hit.face;
+  }
+
+  // Atributos completos (punto, normal, textura) del impacto ganador
+  Intersect surface(const Hit& hit, const Ray& ray) const {
+    if (!isBlock(hit.primitive)) {
+      return object(hit.primitive).rayIntersect(ray);
+    }
+    return Cube::surface(blockMin(hit.primitive), blockMax(hit.primitive), blockTypes[blockIds[hit.primitive]].textures,
+                         ray.at(hit.dist), hit.dist, hit.face);
+  }
+
+  // Solo la distancia de impacto dentro de [tMin, tMax], para los objetos que no son bloques
+  bool hitDistance(int id, const Ray& ray, float& dist) const {
+    Intersect hit = object(id).rayIntersect(ray);
+    dist = hit.dist;
+    return hit.isIntersecting && hit.dist >= ray.tMin && hit.dist <= ray.tMax;
+  }
+
+  // ¿El primitivo `id` corta el rayo a distancia en (tMin, tMax)?
+  bool occluded(int id, const Ray& ray, float& hitDist) const {
+    if (!isBlock(id)) {
+      return object(id).occluded(ray, hitDist);
+    }
+    float dist;
+    if (blocks.intersect(id, ray, dist) && dist > ray.tMin && dist < ray.tMax) {
+      hitDist = dist;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  glm::vec3 blockMin(int id) const {
+    return glm::vec3(blocks.minX[id], blocks.minY[id], blocks.minZ[id]);
+  }
+
+  glm::vec3 blockMax(int id) const {
+    return glm::vec3(blocks.maxX[id], blocks.maxY[id], blocks.maxZ[id]);
+  }
+
+  BoxSoA blocks;
+  std::vector<BlockId> blockIds;
+  std::vector<BlockType> blockTypes;
+  std::vector<std::unique_ptr<Object>> objects;
+};
@@ -0,0 +1,441 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "binaryfile.h"
+#include "block.h"
+#include "bvh.h"
+#include "diorama.h"
+#include "light.h"
+#include "mappedfile.h"
+#include "material.h"
+#include "renderer.h"
+#include "timeline.h"
+
+// Textura que usa la escena: clave, archivo (relativo al archivo de escena) y
+// tamaño con el que se escalan las coordenadas
+struct TextureBinding {
+    std::string key;
+    std::string path;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// Tipo de bloque por nombres de textura; "" usa el color del material
+struct BlockTypeBinding {
+    std::string name;
+    std::string top;
+    std::string side;
+    std::string bottom;
+    Material material;
+};
+
+// Escena leída de un archivo de texto o de su caché compilada: texturas, tipos
+// de bloque, bloques ya expandidos por columnas, luz, cámara y, si vino de la
+// caché, el BVH ya construido.
+struct SceneDocument {
+    std::vector<TextureBinding> textures;
+    std::vector<BlockTypeBinding> blockTypes;
+    std::vector<float> columns[6]; // min x, y, z, max x, y, z de cada bloque
+    std::vector<BlockId> blockIds;
+    bool hasLight = false;
+    Light light = {};
+    bool hasCamera = false;
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraTarget = glm::vec3(0.0f);
+    std::vector<BVHNode> bvhNodes;
+    std::vector<int> bvhPrimitiveIds;
+
+    std::filesystem::path directory; // las rutas de las texturas son relativas a este directorio
+    std::string cachePath;           // dónde se guarda la versión compilada ("" si no se guarda)
+    std::uint64_t sourceHash = 0;    // del texto del que salió; la caché vale mientras coincida
+    bool fromCache = false;
+
+    int blockCount() const {
+        return static_cast<int>(blockIds.size());
+    }
+
+    std::string texturePath(const TextureBinding& texture) const {
+        return (directory / texture.path).string();
+    }
+
+    void addBlock(const glm::vec3& minBound, const glm::vec3& maxBound, BlockId type) {
+        glm::vec3 low = glm::min(minBound, maxBound);
+        glm::vec3 high = glm::max(minBound, maxBound);
+        const float values[6] = {low.x, low.y, low.z, high.x, high.y, high.z};
+        for (int c = 0; c < 6; c++) {
+            columns[c].push_back(values[c]);
+        }
+        blockIds.push_back(type);
+    }
+
+    // Arma la escena de `renderer`, que tiene que estar vacía, con las texturas
+    // ya cargadas. Con el BVH de la caché el renderer no lo vuelve a construir.
+    void apply(Renderer& renderer) const {
+        auto texture = [](const std::string& key) {
+            return key.empty() ? NO_TEXTURE : ImageLoader::getHandle(key);
+        };
+        for (const BlockTypeBinding& type : blockTypes) {
+            renderer.scene.addBlockType(BlockType{type.name, FaceTextures{texture(type.top), texture(type.side), texture(type.bottom)}, type.material});
+        }
+        const float* const blockColumns[6] = {columns[0].data(), columns[1].data(), columns[2].data(),
+                                              columns[3].data(), columns[4].data(), columns[5].data()};
+        renderer.scene.addBlocks(blockCount(), blockColumns, blockIds.data());
+        if (hasLight) {
+            renderer.light = light;
+        }
+        if (!bvhNodes.empty()) {
+            renderer.restoreBvh(bvhNodes, bvhPrimitiveIds);
+        }
+    }
+};
+
+// Archivos de escena. El texto tiene una directiva por línea (ver README):
+//
+//   texture CLAVE ARCHIVO ANCHO ALTO
+//   material NOMBRE R G B ALBEDO SPEC_ALBEDO SPEC_COEF REFLEJO TRANSPARENCIA REFRACCION
+//   blocktype NOMBRE ARRIBA LADOS ABAJO MATERIAL    (textura "-": color del material)
+//   block TIPO X0 Y0 Z0 X1 Y1 Z1
+//   terrain TAMAÑO SEMILLA                           (usa los tipos grass, oak, leaf y diamond)
+//   light X Y Z INTENSIDAD R G B
+//   camera X Y Z OBJETIVO_X OBJETIVO_Y OBJETIVO_Z
+//
+// La versión compilada (.sr1s) guarda todo ya expandido, con los bloques por
+// columnas y el BVH construido, y se abre proyectada en memoria: no se parsea
+// ni se construye nada.
+class SceneFile {
+public:
+    // Abre `path`: un .sr1s directamente, o un archivo de texto usando su .sr1s
+    // hermano si se compiló de este mismo texto
+    static SceneDocument open(const std::string& path) {
+        std::filesystem::path file(path);
+        if (file.extension() == CACHE_EXTENSION) {
+            SceneDocument document = readCache(path);
+            document.directory = file.parent_path();
+            return document;
+        }
+
+        std::ifstream input(path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("Unable to open scene " + path);
+        }
+        std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::uint64_t hash = fnv1a(text);
+        std::string cachePath = std::filesystem::path(file).replace_extension(CACHE_EXTENSION).string();
+
+        if (std::filesystem::exists(cachePath)) {
+            try {
+                SceneDocument document = readCache(cachePath);
+                if (document.sourceHash == hash) {
+                    document.directory = file.parent_path();
+                    document.cachePath = cachePath;
+                    return document;
+                }
+            } catch (const std::exception&) {
+                // Caché de otra versión o dañada: se vuelve a compilar
+            }
+        }
+
+        SceneDocument document = parse(text, path);
+        document.directory = file.parent_path();
+        document.cachePath = cachePath;
+        document.sourceHash = hash;
+        return document;
+    }
+
+    // Guarda la versión compilada si la escena vino del texto. Usa el BVH del
+    // renderer (construyéndolo si hace falta), así que va después de start().
+    // Los errores de escritura solo se avisan: la caché es opcional.
+    static void updateCache(const SceneDocument& document, Renderer& renderer, std::ostream& log) {
+        if (document.fromCache || document.cachePath.empty()) {
+            return;
+        }
+        try {
+            StartupTimeline::Scope timing("guardar " + document.cachePath);
+            writeCache(document.cachePath, document, renderer);
+            log << "Escena compilada en " << document.cachePath << std::endl;
+        } catch (const std::exception& error) {
+            log << "Aviso: no se pudo guardar la caché de escena: " << error.what() << std::endl;
+        }
+    }
+
+    static void writeCache(const std::string& path, const SceneDocument& document, Renderer& renderer) {
+        const BVH& bvh = renderer.builtBvh();
+        const Scene& scene = renderer.scene;
+        const BoxSoA& boxes = scene.blockBoxes();
+        const std::uint32_t blockCount = static_cast<std::uint32_t>(scene.blockCount());
+
+        BinaryWriter out(path, ALIGNMENT);
+        out.put(MAGIC);
+        out.put(VERSION);
+        out.put(static_cast<std::uint32_t>(sizeof(BVHNode)));
+        out.put(document.sourceHash);
+        out.put(static_cast<std::uint32_t>(document.textures.size()));
+        for (const TextureBinding& texture : document.textures) {
+            out.putString(texture.key);
+            out.putString(texture.path);
+            out.put(texture.width);
+            out.put(texture.height);
+        }
+        out.put(static_cast<std::uint32_t>(document.blockTypes.size()));
+        for (const BlockTypeBinding& type : document.blockTypes) {
+            out.putString(type.name);
+            out.putString(type.top);
+            out.putString(type.side);
+            out.putString(type.bottom);
+            out.put(type.material);
+        }
+        out.put(static_cast<std::uint32_t>(document.hasLight));
+        out.put(document.light);
+        out.put(static_cast<std::uint32_t>(document.hasCamera));
+        out.put(document.cameraPosition);
+        out.put(document.cameraTarget);
+
+        out.put(blockCount);
+        for (const float* column : {boxes.minX, boxes.minY, boxes.minZ, boxes.maxX, boxes.maxY, boxes.maxZ}) {
+            out.putArray(column, blockCount);
+        }
+        std::vector<BlockId> types(blockCount);
+        for (std::uint32_t i = 0; i < blockCount; i++) {
+            types[i] = scene.blockId(static_cast<int>(i));
+        }
+        out.putArray(types.data(), blockCount);
+
+        out.put(static_cast<std::uint32_t>(bvh.getNodes().size()));
+        out.putArray(bvh.getNodes().data(), bvh.getNodes().size());
+        out.putArray(bvh.getPrimitiveIds().data(), bvh.getPrimitiveIds().size());
+        out.finish();
+    }
+
+    static SceneDocument readCache(const std::string& path) {
+        MappedFile file(path);
+        BinaryReader in(file.data(), file.size(), ALIGNMENT, path);
+        if (in.get<std::uint32_t>() != MAGIC || in.get<std::uint32_t>() != VERSION ||
+            in.get<std::uint32_t>() != sizeof(BVHNode)) {
+            throw std::runtime_error(path + " is not a scene cache of this version");
+        }
+
+        SceneDocument document;
+        document.fromCache = true;
+        document.sourceHash = in.get<std::uint64_t>();
+        document.textures.resize(in.get<std::uint32_t>());
+        for (TextureBinding& texture : document.textures) {
+            texture.key = in.getString();
+            texture.path = in.getString();
+            texture.width = in.get<float>();
+            texture.height = in.get<float>();
+        }
+        document.blockTypes.resize(in.get<std::uint32_t>());
+        for (BlockTypeBinding& type : document.blockTypes) {
+            type.name = in.getString();
+            type.top = in.getString();
+            type.side = in.getString();
+            type.bottom = in.getString();
+            type.material = in.get<Material>();
+        }
+        document.hasLight = in.get<std::uint32_t>() != 0;
+        document.light = in.get<Light>();
+        document.hasCamera = in.get<std::uint32_t>() != 0;
+        document.cameraPosition = in.get<glm::vec3>();
+        document.cameraTarget = in.get<glm::vec3>();
+
+        // Los arreglos se copian de la proyección con un memcpy por columna
+        const std::uint32_t blockCount = in.get<std::uint32_t>();
+        for (std::vector<float>& column : document.columns) {
+            in.getArray(column, blockCount);
+        }
+        in.getArray(document.blockIds, blockCount);
+        const std::uint32_t nodeCount = in.get<std::uint32_t>();
+        in.getArray(document.bvhNodes, nodeCount);
+        in.getArray(document.bvhPrimitiveIds, blockCount);
+
+        // Sin bloques no hay árbol que recorrer: el renderer arma el suyo vacío
+        if (blockCount == 0) {
+            document.bvhNodes.clear();
+        }
+        // Índices fuera de rango romperían el recorrido: mejor rechazar el archivo
+        for (BlockId type : document.blockIds) {
+            in.check(type < document.blockTypes.size());
+        }
+        // El orden de las hojas es una permutación de los bloques (BVH::restore lo exige)
+        std::vector<bool> listed(blockCount, false);
+        for (int id : document.bvhPrimitiveIds) {
+            in.check(id >= 0 && static_cast<std::uint32_t>(id) < blockCount && !listed[id]);
+            listed[id] = true;
+        }
+        // Lo mismo con los números: un NaN o inf en una caja, un nodo, la luz o
+        // la cámara llegaría al renderer como rayos y cámaras no finitos
+        auto checkFinite = [&in](const glm::vec3& value) {
+            in.check(std::isfinite(value.x) && std::isfinite(value.y) && std::isfinite(value.z));
+        };
+        for (const std::vector<float>& column : document.columns) {
+            for (float value : column) {
+                in.check(std::isfinite(value));
+            }
+        }
+        for (const BVHNode& node : document.bvhNodes) {
+            checkFinite(node.bounds.min);
+            checkFinite(node.bounds.max);
+        }
+        for (const BlockTypeBinding& type : document.blockTypes) {
+            const Material& material = type.material;
+            checkFinite(material.diffuse);
+            for (float value : {material.albedo, material.specularAlbedo, material.specularCoefficient,
+                                material.reflectivity, material.transparency, material.refractionIndex}) {
+                in.check(std::isfinite(value));
+            }
+        }
+        checkFinite(document.light.position);
+        checkFinite(document.light.color);
+        in.check(std::isfinite(document.light.intensity));
+        checkFinite(document.cameraPosition);
+        checkFinite(document.cameraTarget);
+        // Los hijos van siempre después del padre, así que una pasada en orden
+        // recorre el árbol desde la raíz: cada nodo alcanzable ya tiene su
+        // profundidad al llegar a él. Un hijo hacia atrás haría un ciclo y un
+        // árbol más hondo que BVH::MAX_DEPTH desbordaría la pila del recorrido.
+        std::vector<int> depths(document.bvhNodes.size(), -1);
+        if (!depths.empty()) {
+            depths[0] = 0;
+        }
+        for (std::size_t index = 0; index < document.bvhNodes.size(); index++) {
+            const BVHNode& node = document.bvhNodes[index];
+            if (node.count > 0) {
+                in.check(node.leftOrFirst >= 0 && static_cast<std::uint32_t>(node.leftOrFirst) + node.count <= blockCount);
+                continue;
+            }
+            in.check(node.leftOrFirst > 0 && static_cast<std::size_t>(node.leftOrFirst) > index &&
+                     static_cast<std::uint32_t>(node.leftOrFirst) + 1 < nodeCount);
+            if (depths[index] < 0) {
+                continue;
+            }
+            in.check(depths[index] < BVH::MAX_DEPTH);
+            for (int child = node.leftOrFirst; child <= node.leftOrFirst + 1; child++) {
+                depths[child] = std::max(depths[child], depths[index] + 1);
+            }
+        }
+        return document;
+    }
+
+    static SceneDocument parse(const std::string& text, const std::string& name) {
+        SceneDocument document;
+        std::map<std::string, Material> materials;
+        std::map<std::string, BlockId> typeIds;
+        auto findType = [&typeIds](const std::string& type) {
+            auto it = typeIds.find(type);
+            if (it == typeIds.end()) {
+                throw std::runtime_error("Block type not found: " + type);
+            }
+            return it->second;
+        };
+
+        std::istringstream lines(text);
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(lines, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream fields(line);
+            std::string directive;
+            if (!(fields >> directive)) {
+                continue;
+            }
+            try {
+                if (directive == "texture") {
+                    TextureBinding texture;
+                    fields >> texture.key >> texture.path >> texture.width >> texture.height;
+                    expect(fields);
+                    document.textures.push_back(texture);
+                } else if (directive == "material") {
+                    std::string materialName;
+                    Material material = {};
+                    fields >> materialName >> material.diffuse.x >> material.diffuse.y >> material.diffuse.z >> material.albedo >>
+                        material.specularAlbedo >> material.specularCoefficient >> material.reflectivity >> material.transparency >>
+                        material.refractionIndex;
+                    expect(fields);
+                    materials[materialName] = material;
+                } else if (directive == "blocktype") {
+                    BlockTypeBinding type;
+                    std::string materialName;
+                    fields >> type.name >> type.top >> type.side >> type.bottom >> materialName;
+                    expect(fields);
+                    for (std::string* key : {&type.top, &type.side, &type.bottom}) {
+                        if (*key == "-") {
+                            key->clear();
+                        }
+                    }
+                    auto material = materials.find(materialName);
+                    if (material == materials.end()) {
+                        throw std::runtime_error("Material not found: " + materialName);
+                    }
+                    type.material = material->second;
+                    typeIds[type.name] = static_cast<BlockId>(document.blockTypes.size());
+                    document.blockTypes.push_back(type);
+                } else if (directive == "block") {
+                    std::string type;
+                    glm::vec3 minBound, maxBound;
+                    fields >> type >> minBound.x >> minBound.y >> minBound.z >> maxBound.x >> maxBound.y >> maxBound.z;
+                    expect(fields);
+                    document.addBlock(minBound, maxBound, findType(type));
+                } else if (directive == "terrain") {
+                    int size;
+                    std::uint32_t seed;
+                    fields >> size >> seed;
+                    expect(fields);
+                    addTerrain(size, seed, findType("grass"), findType("oak"), findType("leaf"), findType("diamond"),
+                               [&document](const glm::vec3& minBound, const glm::vec3& maxBound, BlockId type) {
+                                   document.addBlock(minBound, maxBound, type);
+                               });
+                } else if (directive == "light") {
+                    Light& light = document.light;
+                    fields >> light.position.x >> light.position.y >> light.position.z >> light.intensity >> light.color.x >>
+                        light.color.y >> light.color.z;
+                    expect(fields);
+                    document.hasLight = true;
+                } else if (directive == "camera") {
+                    glm::vec3& position = document.cameraPosition;
+                    glm::vec3& target = document.cameraTarget;
+                    fields >> position.x >> position.y >> position.z >> target.x >> target.y >> target.z;
+                    expect(fields);
+                    document.hasCamera = true;
+                } else {
+                    throw std::runtime_error("unknown directive " + directive);
+                }
+            } catch (const std::exception& error) {
+                throw std::runtime_error(name + ":" + std::to_string(lineNumber) + ": " + error.what());
+            }
+        }
+        return document;
+    }
+
+private:
+    static constexpr std::uint32_t MAGIC = 0x53315253; // "SR1S"
+    static constexpr std::uint32_t VERSION = 1;
+    inline static const char* CACHE_EXTENSION = ".sr1s";
+
+    static void expect(std::istringstream& fields) {
+        if (!fields) {
+            throw std::runtime_error("missing or invalid values");
+        }
+    }
+
+    static std::uint64_t fnv1a(const std::string& text) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Los arreglos van alineados a 16 bytes
+    static constexpr size_t ALIGNMENT = 16;
+};
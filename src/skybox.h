@@ -1,93 +1,353 @@
 #pragma once
 #include <glm/glm.hpp>
-#include "intersect.h"
-#include "object.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
 #include <string>
+#include <vector>
+#include "color.h"
+#include "radiance.h"
 #include "imageloader.h"
-#include <cmath>
+#include "ray.h"
+#include "raybox.h"
+#include "timeline.h"
 
-class Skybox
+inline Radiance texelRadiance(const Color& texel)
 {
+  return toRadiance(texel);
+}
 
-public:
-  static Color getColor(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection)
-  {
+inline Radiance texelRadiance(const Radiance& texel)
+{
+  return texel;
+}
 
-    glm::vec3 minBound(-100.0f, -50.0f, 100.0f);
-    glm::vec3 maxBound(100.0f, 70.0f, -100.0f);
+// Mapa cúbico indexado por dirección: seis caras cuadradas de `size` texels, en
+// el orden de BoxFace y con las coordenadas de faceAxes. Muestrear es elegir el
+// eje dominante y dividir, sin intersecciones. Los texels son Color (sRGB de 8
+// bits) o Radiance; al muestrear siempre se devuelve radiancia lineal.
+template <typename Texel>
+struct CubeMap
+{
+  int size = 0;
+  std::vector<Texel> texels; // cara * size * size + v * size + u
+  const Texel* mapped = nullptr; // si no es nulo, los texels están en un paquete proyectado
 
-    glm::vec3 invRayDir = 1.0f / rayDirection;
+  void resize(int newSize)
+  {
+    size = newSize;
+    texels.assign(static_cast<size_t>(6) * size * size, Texel());
+    mapped = nullptr;
+  }
 
-    glm::vec3 t1 = (minBound - rayOrigin) * invRayDir;
-    glm::vec3 t2 = (maxBound - rayOrigin) * invRayDir;
+  // Usa texels ya horneados sin copiarlos; tienen que vivir mientras se use el mapa
+  void map(int newSize, const Texel* newTexels)
+  {
+    size = newSize;
+    texels.clear();
+    mapped = newTexels;
+  }
 
-    glm::vec3 tmin = glm::min(t1, t2);
-    glm::vec3 tmax = glm::max(t1, t2);
+  const Texel* data() const
+  {
+    return mapped ? mapped : texels.data();
+  }
+
+  Texel& texel(int face, int u, int v)
+  {
+    return texels[(static_cast<size_t>(face) * size + v) * size + u];
+  }
 
-    float tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
-    float tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+  const Texel& texel(int face, int u, int v) const
+  {
+    return data()[(static_cast<size_t>(face) * size + v) * size + u];
+  }
 
-    if (tNear > tFar || tFar < 0)
+  // Cara y coordenadas en [0, 1] de la dirección (no hace falta normalizarla).
+  // Con una dirección nula o no finita (NaN, inf) la cara sigue siendo válida
+  // y uv queda en su centro.
+  static int project(const glm::vec3& direction, glm::vec2& uv)
+  {
+    glm::vec3 absDir = glm::abs(direction);
+    int axis = (absDir.x >= absDir.y) ? ((absDir.x >= absDir.z) ? 0 : 2) : ((absDir.y >= absDir.z) ? 1 : 2);
+    int face = axis * 2 + (direction[axis] > 0.0f ? 1 : 0);
+    int uAxis, vAxis;
+    faceAxes(face, uAxis, vAxis);
+    float scale = 0.5f / absDir[axis];
+    uv = glm::vec2(direction[uAxis] * scale + 0.5f, direction[vAxis] * scale + 0.5f);
+    if (!std::isfinite(uv.x) || !std::isfinite(uv.y))
     {
-      return Color(173, 216, 230);
+      uv = glm::vec2(0.5f);
     }
+    return face;
+  }
 
-    float dist = (tNear < 0) ? tFar : tNear;
+  // Dirección hacia el centro del texel (u, v) de la cara
+  glm::vec3 direction(int face, int u, int v) const
+  {
+    int uAxis, vAxis;
+    faceAxes(face, uAxis, vAxis);
+    glm::vec3 direction;
+    direction[face / 2] = (face % 2) ? 1.0f : -1.0f;
+    direction[uAxis] = 2.0f * (u + 0.5f) / size - 1.0f;
+    direction[vAxis] = 2.0f * (v + 0.5f) / size - 1.0f;
+    return direction;
+  }
 
-    glm::vec3 point = rayOrigin + dist * rayDirection;
+  // Texel más cercano
+  Radiance sample(const glm::vec3& direction) const
+  {
+    glm::vec2 uv;
+    int face = project(direction, uv);
+    return sample(face, uv);
+  }
+
+  // Con la cara y las coordenadas que ya devolvió project()
+  Radiance sample(int face, const glm::vec2& uv) const
+  {
+    int u = static_cast<int>(clampToFace(uv.x * size));
+    int v = static_cast<int>(clampToFace(uv.y * size));
+    return texelRadiance(texel(face, u, v));
+  }
+
+  // Interpolación bilineal dentro de la cara; en los bordes se repite el último texel
+  Radiance sampleLinear(const glm::vec3& direction) const
+  {
+    glm::vec2 uv;
+    int face = project(direction, uv);
+    return sampleLinear(face, uv);
+  }
+
+  Radiance sampleLinear(int face, const glm::vec2& uv) const
+  {
+    float x = clampToFace(uv.x * size - 0.5f);
+    float y = clampToFace(uv.y * size - 0.5f);
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    int x1 = std::min(x0 + 1, size - 1);
+    int y1 = std::min(y0 + 1, size - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    Radiance top = glm::mix(texelRadiance(texel(face, x0, y0)), texelRadiance(texel(face, x1, y0)), fx);
+    Radiance bottom = glm::mix(texelRadiance(texel(face, x0, y1)), texelRadiance(texel(face, x1, y1)), fx);
+    return glm::mix(top, bottom, fy);
+  }
 
-    // Calcula la normal basada en el lado del cubo
-    const float epsilon = 0.0001;
-    glm::vec3 normal(0.0f);
-    if (glm::abs(point.x - minBound.x) < epsilon)
+  // Coordenada en texels dentro de [0, size - 1]; un NaN va a 0, así el índice
+  // nunca sale de la cara
+  float clampToFace(float coordinate) const
+  {
+    return (coordinate > 0.0f) ? std::min(coordinate, size - 1.0f) : 0.0f;
+  }
+
+  // Cara `face` de la versión reducida `factor` veces, promediando en lineal
+  // bloques de factor x factor texels; `result` ya tiene el tamaño reducido
+  void downsampleFace(int face, int factor, CubeMap<Radiance>& result) const
+  {
+    for (int v = 0; v < result.size; v++)
     {
-      // -x (Left side of the cube)
-      return loadTexture(std::abs(point.z - minBound.z), std::abs(point.y - minBound.y), std::abs(maxBound.z - minBound.z), std::abs(maxBound.y - minBound.y), "skybox2");
+      for (int u = 0; u < result.size; u++)
+      {
+        Radiance sum(0.0f);
+        int count = 0;
+        for (int y = v * factor; y < std::min((v + 1) * factor, size); y++)
+        {
+          for (int x = u * factor; x < std::min((u + 1) * factor, size); x++)
+          {
+            sum += texelRadiance(texel(face, x, y));
+            count++;
+          }
+        }
+        result.texel(face, u, v) = sum / static_cast<float>(std::max(count, 1));
+      }
     }
-    else if (glm::abs(point.x - maxBound.x) < epsilon)
-    {
-      // x (Right side of the cube)
-      return loadTexture(std::abs(point.z - minBound.z), std::abs(point.y - minBound.y), std::abs(maxBound.z - minBound.z), std::abs(maxBound.y - minBound.y), "skybox4");
+  }
+};
+
+// Cielo a distancia infinita. Las seis imágenes se hornean en un mapa cúbico,
+// y en otro reducido y prefiltrado para los rayos reflejados, que se ven
+// borrosos y a los que no les hace falta el detalle. Cada cara se hornea la
+// primera vez que un rayo llega a ella, así que las imágenes que solo se ven
+// desde caras a las que no llega ningún rayo ni se decodifican.
+class Skybox
+{
+
+public:
+  static constexpr int CUBE_SIZE = 512;
+  static constexpr int PREFILTER_FACTOR = 32;
 
+  // Claves de las imágenes del cielo: los frontends las registran diferidas
+  static bool isSource(const std::string& key)
+  {
+    for (const char* source : SOURCE_KEYS)
+    {
+      if (key == source)
+      {
+        return true;
+      }
     }
-    else if (glm::abs(point.y - minBound.y) < epsilon)
+    return false;
+  }
+
+  // Color del cielo en la dirección del rayo primario
+  static Radiance getColor(const glm::vec3 &rayDirection)
+  {
+    glm::vec2 uv;
+    int face = CubeMap<Color>::project(rayDirection, uv);
+    ensureFace(face);
+    return cubeMap.sample(face, uv);
+  }
+
+  // Color del cielo para rayos secundarios, desde el mapa prefiltrado
+  static Radiance getReflectionColor(const glm::vec3 &rayDirection)
+  {
+    glm::vec2 uv;
+    int face = CubeMap<Radiance>::project(rayDirection, uv);
+    ensureFace(face);
+    return prefiltered.sampleLinear(face, uv);
+  }
+
+  // Prepara los mapas cúbicos sin hornear ninguna cara; llamar después de
+  // registrar las imágenes y antes de renderizar. Con los mapas de un paquete
+  // (useBaked) no hace nada.
+  static void loadTextures()
+  {
+    if (cubeMap.mapped)
     {
-      // -y
-      return loadTexture(std::abs(point.x - minBound.x), std::abs(point.z - minBound.z), std::abs(maxBound.x - minBound.x), std::abs(maxBound.z- minBound.z), "skybox_ground");
-      
+      return;
     }
-    else if (glm::abs(point.y - maxBound.y) < epsilon)
+    back = ImageLoader::getHandle("skybox1");
+    left = ImageLoader::getHandle("skybox2");
+    front = ImageLoader::getHandle("skybox3");
+    right = ImageLoader::getHandle("skybox4");
+    ground = ImageLoader::getHandle("skybox_ground");
+    sky = ImageLoader::getHandle("skybox_sky");
+
+    cubeMap.resize(CUBE_SIZE);
+    prefiltered.resize(std::max(1, CUBE_SIZE / PREFILTER_FACTOR));
+    for (std::atomic<bool>& ready : faceReady)
     {
-      // y (Top side of the cube)
-      return loadTexture(std::abs(point.x - minBound.x), std::abs(point.z - minBound.z), std::abs(maxBound.x - minBound.x), std::abs(maxBound.z- minBound.z), "skybox_sky");
+      ready.store(false, std::memory_order_relaxed);
     }
-    else if (glm::abs(point.z - minBound.z) < epsilon)
+  }
+
+  // Hornea las caras que falten, p. ej. para guardar los mapas completos
+  static void bakeAll()
+  {
+    for (int face = 0; face < 6; face++)
     {
-      // -z (Back side of the cube)
-      return loadTexture(std::abs(point.x - minBound.x), std::abs(point.y - minBound.y), std::abs(maxBound.x - minBound.x), std::abs(maxBound.y - minBound.y), "skybox1");
+      ensureFace(face);
+    }
+  }
 
+  // Mapas horneados por otra corrida, proyectados desde un paquete. Se
+  // descartan si no tienen los tamaños que hornearía loadTextures().
+  static bool useBaked(int cubeSize, const Color* cubeTexels, int prefilteredSize, const Radiance* prefilteredTexels)
+  {
+    if (cubeSize != CUBE_SIZE || prefilteredSize != std::max(1, CUBE_SIZE / PREFILTER_FACTOR))
+    {
+      return false;
     }
-    else if (glm::abs(point.z - maxBound.z) < epsilon)
+    cubeMap.map(cubeSize, cubeTexels);
+    prefiltered.map(prefilteredSize, prefilteredTexels);
+    for (std::atomic<bool>& ready : faceReady)
     {
-      // z (Front side of the cube)
-      return loadTexture(std::abs(point.x - minBound.x), std::abs(point.y - minBound.y), std::abs(maxBound.x - minBound.x), std::abs(maxBound.y - minBound.y), "skybox3");
-
+      ready.store(true, std::memory_order_release);
     }
+    return true;
   }
 
-  static Color loadTexture(float x, float y, float surfaceWidth, float surfaceHeight, const std::string texturekey)
+  static const CubeMap<Color>& bakedCube()
   {
+    return cubeMap;
+  }
 
-    glm::vec2 tsize = ImageLoader::getImageSize(texturekey);
+  static const CubeMap<Radiance>& bakedPrefiltered()
+  {
+    return prefiltered;
+  }
 
+  static Color loadTexture(float x, float y, float surfaceWidth, float surfaceHeight, TextureHandle texture)
+  {
     float normalizedX = x / surfaceWidth;
     float normalizedY = y / surfaceHeight;
 
-    int tx = static_cast<int>(std::fmod(normalizedX * tsize.x, tsize.x));
-    int ty = static_cast<int>(std::fmod(normalizedY * tsize.y, tsize.y));
+    return ImageLoader::texture(texture).sample(normalizedX, normalizedY);
+  };
 
-    Color c = ImageLoader::getPixelColor(texturekey, tx, ty);
+private:
+  inline static const char* SOURCE_KEYS[] = {"skybox1", "skybox2", "skybox3", "skybox4", "skybox_ground", "skybox_sky"};
 
-    return c;
-  };
+  // Hornea la cara la primera vez que se pide; si varios hilos la piden a la
+  // vez, uno la hornea y los demás esperan
+  static void ensureFace(int face)
+  {
+    if (faceReady[face].load(std::memory_order_acquire))
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(faceMutex[face]);
+    if (faceReady[face].load(std::memory_order_relaxed))
+    {
+      return;
+    }
+    StartupTimeline::Scope timing("hornear cara " + std::to_string(face) + " del cielo");
+    for (int v = 0; v < CUBE_SIZE; v++)
+    {
+      for (int u = 0; u < CUBE_SIZE; u++)
+      {
+        cubeMap.texel(face, u, v) = boxColor(cubeMap.direction(face, u, v));
+      }
+    }
+    cubeMap.downsampleFace(face, PREFILTER_FACTOR, prefiltered);
+    faceReady[face].store(true, std::memory_order_release);
+  }
+
+  // La caja de 200x120x200 en la que se pegaban las imágenes, vista desde el
+  // origen de la escena; se usa solo para hornear el mapa cúbico
+  static Color boxColor(const glm::vec3 &direction)
+  {
+    glm::vec3 minBound(-100.0f, -50.0f, 100.0f);
+    glm::vec3 maxBound(100.0f, 70.0f, -100.0f);
+
+    BoxHit hit;
+    if (!rayBox(glm::min(minBound, maxBound), glm::max(minBound, maxBound), Ray(glm::vec3(0.0f), direction), hit))
+    {
+      return Color(173, 216, 230);
+    }
+    glm::vec3 point = direction * hit.dist;
+    glm::vec3 extent = glm::abs(maxBound - minBound);
+    glm::vec3 offset = glm::abs(point - minBound);
+
+    switch (hit.face)
+    {
+      case FACE_MIN_X:
+        return loadTexture(offset.z, offset.y, extent.z, extent.y, left);
+      case FACE_MAX_X:
+        return loadTexture(offset.z, offset.y, extent.z, extent.y, right);
+      case FACE_MIN_Y:
+        return loadTexture(offset.x, offset.z, extent.x, extent.z, ground);
+      case FACE_MAX_Y:
+        return loadTexture(offset.x, offset.z, extent.x, extent.z, sky);
+      case FACE_MAX_Z:
+        // z = minBound.z: la cara de atrás
+        return loadTexture(offset.x, offset.y, extent.x, extent.y, back);
+      default:
+        return loadTexture(offset.x, offset.y, extent.x, extent.y, front);
+    }
+  }
+
+  inline static TextureHandle back = NO_TEXTURE;
+  inline static TextureHandle left = NO_TEXTURE;
+  inline static TextureHandle front = NO_TEXTURE;
+  inline static TextureHandle right = NO_TEXTURE;
+  inline static TextureHandle ground = NO_TEXTURE;
+  inline static TextureHandle sky = NO_TEXTURE;
+
+  inline static CubeMap<Color> cubeMap;
+  inline static CubeMap<Radiance> prefiltered;
+  inline static std::atomic<bool> faceReady[6] = {};
+  inline static std::mutex faceMutex[6];
 };
@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "color.h"
+#include "counters.h"
+#include "framebuffer.h"
+#include "globals.h"
+#include "renderer.h"
+
+// Estadísticas por cuadro del modo interactivo: junta los contadores y los
+// tiempos de cada intervalo, los dibuja sobre la imagen con una fuente de
+// mapa de bits y los escribe a stdout y, si se pide, a un CSV.
+class StatsOverlay {
+public:
+  void setVisible(bool value) {
+    visible = value;
+  }
+
+  bool isVisible() const {
+    return visible;
+  }
+
+  // Abre el archivo CSV donde se escribe una fila por intervalo
+  void openCsv(const std::string& path) {
+    csv.open(path);
+    if (!csv) {
+      std::cerr << "Error: no se pudo abrir " << path << std::endl;
+      return;
+    }
+    csv << "seconds,frames,frameMs,presentMs,reprojectMs,traceMs,tonemapMs,primaryRays,shadowRays,reflectRays,"
+           "refractRays,skyboxRays,intersectionTests,textureFetches";
+    for (int depth = 0; depth <= MAX_RECURSION; depth++) {
+      csv << ",depth" << depth;
+    }
+    csv << "\n";
+  }
+
+  // Un cuadro del bucle principal: lo que tardó entero y lo que tardó en presentarse
+  void addFrame(double frameMs, double presentMs) {
+    frames++;
+    totalFrameMs += frameMs;
+    totalPresentMs += presentMs;
+  }
+
+  // Cierra el intervalo de `seconds`: toma los contadores del renderer, rearma
+  // el texto y escribe la fila a stdout y al CSV
+  void update(Renderer& renderer, double seconds) {
+    Renderer::FrameStats stats = renderer.collectFrameStats();
+    elapsed += seconds;
+    int count = std::max(frames, 1);
+    double frameMs = totalFrameMs / count;
+    double presentMs = totalPresentMs / count;
+    const Counters::Totals& counters = stats.counters;
+
+    lines.clear();
+    lines.push_back(format("%.1f FPS  %.2f MS/CUADRO  PRES %.2f MS", frames / seconds, frameMs, presentMs));
+    lines.push_back(format("CPU MS TRAZ %.2f TONE %.2f REPR %.2f", stats.traceMs / count, stats.tonemapMs / count,
+                           stats.reprojectMs / count));
+    if (Counters::enabled) {
+      lines.push_back("RAYOS/S " + compact(counters.rays() / seconds) + "  PRUEBAS/S " +
+                      compact(counters[Counters::INTERSECTION_TESTS] / seconds) + "  TEXELS/S " +
+                      compact(counters[Counters::TEXTURE_FETCHES] / seconds));
+      lines.push_back("PRIM " + compact(counters[Counters::PRIMARY_RAYS] / count) + "  SOMB " +
+                      compact(counters[Counters::SHADOW_RAYS] / count) + "  REFL " +
+                      compact(counters[Counters::REFLECT_RAYS] / count) + "  REFR " +
+                      compact(counters[Counters::REFRACT_RAYS] / count) + "  CIELO " +
+                      compact(counters[Counters::SKYBOX_RAYS] / count));
+      std::string depths = "PROFUNDIDAD";
+      for (int depth = 0; depth <= MAX_RECURSION; depth++) {
+        depths += "  " + std::to_string(depth) + ": " + compact(counters[Counters::DEPTH_0 + depth] / count);
+      }
+      lines.push_back(depths);
+    } else {
+      lines.push_back("CONTADORES DESACTIVADOS (SR1_STATS=0)");
+    }
+
+    for (const std::string& line : lines) {
+      std::cout << line << std::endl;
+    }
+    if (csv) {
+      csv << elapsed << "," << frames << "," << frameMs << "," << presentMs << "," << stats.reprojectMs / count << ","
+          << stats.traceMs / count << "," << stats.tonemapMs / count;
+      for (int i = 0; i < Counters::COUNT; i++) {
+        csv << "," << counters[i] / count;
+      }
+      csv << std::endl;
+    }
+
+    frames = 0;
+    totalFrameMs = 0.0;
+    totalPresentMs = 0.0;
+  }
+
+  // Dibuja el texto del último intervalo en la esquina superior izquierda
+  void draw(Framebuffer& frame) const {
+    if (!visible || lines.empty()) {
+      return;
+    }
+    size_t longest = 0;
+    for (const std::string& line : lines) {
+      longest = std::max(longest, line.size());
+    }
+    const int advance = (GLYPH_WIDTH + 1) * SCALE;
+    const int lineHeight = (GLYPH_HEIGHT + 2) * SCALE;
+    int boxWidth = std::min(frame.width, static_cast<int>(longest) * advance + 2 * MARGIN);
+    int boxHeight = std::min(frame.height, static_cast<int>(lines.size()) * lineHeight + 2 * MARGIN);
+    // Fondo oscurecido para que el texto se lea sobre cualquier imagen
+    for (int y = 0; y < boxHeight; y++) {
+      for (int x = 0; x < boxWidth; x++) {
+        Color& pixel = frame.at(x, y);
+        pixel = Color(pixel.r / 4, pixel.g / 4, pixel.b / 4);
+      }
+    }
+    for (size_t line = 0; line < lines.size(); line++) {
+      int y = MARGIN + static_cast<int>(line) * lineHeight;
+      for (size_t i = 0; i < lines[line].size(); i++) {
+        drawGlyph(frame, MARGIN + static_cast<int>(i) * advance, y, lines[line][i]);
+      }
+    }
+  }
+
+private:
+  static constexpr int GLYPH_WIDTH = 3;
+  static constexpr int GLYPH_HEIGHT = 5;
+  static constexpr int SCALE = 2;
+  static constexpr int MARGIN = 6;
+
+  struct Glyph {
+    char character;
+    const char* rows; // GLYPH_HEIGHT filas de GLYPH_WIDTH, de arriba a abajo
+  };
+
+  // Fuente de 3x5: dígitos, mayúsculas y los signos que usa el texto
+  inline static const Glyph FONT[] = {
+      {'0', "111101101101111"}, {'1', "010110010010111"}, {'2', "111001111100111"}, {'3', "111001111001111"},
+      {'4', "101101111001001"}, {'5', "111100111001111"}, {'6', "111100111101111"}, {'7', "111001001001001"},
+      {'8', "111101111101111"}, {'9', "111101111001111"}, {'A', "010101111101101"}, {'B', "110101110101110"},
+      {'C', "011100100100011"}, {'D', "110101101101110"}, {'E', "111100110100111"}, {'F', "111100110100100"},
+      {'G', "011100101101011"}, {'H', "101101111101101"}, {'I', "111010010010111"}, {'J', "001001001101010"},
+      {'K', "101101110101101"}, {'L', "100100100100111"}, {'M', "101111111101101"}, {'N', "110101101101101"},
+      {'O', "010101101101010"}, {'P', "110101110100100"}, {'Q', "010101101110011"}, {'R', "110101110101101"},
+      {'S', "011100010001110"}, {'T', "111010010010010"}, {'U', "101101101101111"}, {'V', "101101101101010"},
+      {'W', "101101111111101"}, {'X', "101101010101101"}, {'Y', "101101010010010"}, {'Z', "111001010100111"},
+      {'.', "000000000000010"}, {':', "000010000010000"}, {'/', "001001010100100"}, {'%', "101001010100101"},
+      {'-', "000000111000000"}, {'(', "010100100100010"}, {')', "010001001001010"}, {'=', "000111000111000"},
+  };
+
+  static void drawGlyph(Framebuffer& frame, int x0, int y0, char character) {
+    char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+    const Glyph* glyph = std::find_if(std::begin(FONT), std::end(FONT), [upper](const Glyph& g) { return g.character == upper; });
+    if (glyph == std::end(FONT)) {
+      return; // espacios y signos sin dibujo
+    }
+    for (int row = 0; row < GLYPH_HEIGHT; row++) {
+      for (int column = 0; column < GLYPH_WIDTH; column++) {
+        if (glyph->rows[row * GLYPH_WIDTH + column] != '1') {
+          continue;
+        }
+        for (int dy = 0; dy < SCALE; dy++) {
+          for (int dx = 0; dx < SCALE; dx++) {
+            int x = x0 + column * SCALE + dx;
+            int y = y0 + row * SCALE + dy;
+            if (x < frame.width && y < frame.height) {
+              frame.at(x, y) = Color(255, 255, 255);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  template <typename... Args>
+  static std::string format(const char* pattern, Args... args) {
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), pattern, args...);
+    return buffer;
+  }
+
+  // 1234567 -> "1.23M"
+  static std::string compact(double value) {
+    if (value >= 1e9) {
+      return format("%.2fG", value / 1e9);
+    } else if (value >= 1e6) {
+      return format("%.2fM", value / 1e6);
+    } else if (value >= 1e3) {
+      return format("%.1fK", value / 1e3);
+    }
+    return format("%.0f", value);
+  }
+
+  bool visible = true;
+  int frames = 0;
+  double totalFrameMs = 0.0;
+  double totalPresentMs = 0.0;
+  double elapsed = 0.0;
+  std::vector<std::string> lines;
+  std::ofstream csv;
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool persistente con una cola por worker. Cada worker saca de su propia cola
+// (LIFO) y, cuando se queda sin trabajo, roba del frente de las demás. El hilo
+// que llama a wait() también ejecuta tareas mientras espera.
+class ThreadPool {
+public:
+  // threadCount cuenta al hilo que llama; 0 usa todos los núcleos de la máquina.
+  explicit ThreadPool(unsigned threadCount = 0) {
+    if (threadCount == 0) {
+      threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    unsigned workerCount = threadCount - 1;
+    queues = std::vector<Queue>(std::max(1u, workerCount));
+    for (unsigned i = 0; i < workerCount; i++) {
+      workers.emplace_back([this, i] { workerLoop(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned size() const {
+    return static_cast<unsigned>(workers.size()) + 1;
+  }
+
+  void submit(std::function<void()> task) {
+    unsigned slot = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    pending.fetch_add(1);
+    queued.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(queues[slot].mutex);
+      queues[slot].tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+  }
+
+  // Bloquea hasta que todas las tareas enviadas hayan terminado.
+  void wait() {
+    while (pending.load() > 0) {
+      std::function<void()> task;
+      if (steal(0, task)) {
+        run(task);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(doneMutex);
+      done.wait(lock, [this] { return pending.load() == 0; });
+    }
+  }
+
+  // Ejecuta task(i) para i en [0, count) y espera a que terminen todos.
+  void parallelFor(int count, const std::function<void(int)>& task) {
+    for (int i = 0; i < count; i++) {
+      submit([&task, i] { task(i); });
+    }
+    wait();
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool popLocal(unsigned id, std::function<void()>& task) {
+    Queue& queue = queues[id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued.fetch_sub(1);
+    return true;
+  }
+
+  bool steal(unsigned id, std::function<void()>& task) {
+    for (size_t i = 0; i < queues.size(); i++) {
+      Queue& victim = queues[(id + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queued.fetch_sub(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(std::function<void()>& task) {
+    task();
+    if (pending.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(doneMutex);
+      done.notify_all();
+    }
+  }
+
+  void workerLoop(unsigned id) {
+    while (true) {
+      std::function<void()> task;
+      if (popLocal(id, task) || steal(id, task)) {
+        run(task);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+      if (stopping && queued.load() <= 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::vector<Queue> queues;
+  std::atomic<unsigned> nextQueue{0};
+  std::atomic<int> pending{0};
+  std::atomic<int> queued{0};
+
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  std::mutex doneMutex;
+  std::condition_variable done;
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ios>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Línea de tiempo del arranque: cada fase (decodificar una textura, hornear
+// una cara del cielo, construir un acelerador...) queda con su comienzo, su
+// duración y el hilo que la hizo, medidos desde start(). Se puede anotar desde
+// cualquier hilo; report() las lista ordenadas por comienzo.
+class StartupTimeline {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Marca el cero de la línea de tiempo; llamar al comienzo de main(). El
+  // hilo que llama es el hilo 0.
+  static void start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    origin = Clock::now();
+    events.clear();
+    threads.assign(1, std::this_thread::get_id());
+    reported = 0;
+  }
+
+  static void record(const std::string& name, Clock::time_point begin, Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(Event{name, begin, end, threadIndex(std::this_thread::get_id())});
+  }
+
+  // Anota el tiempo entre la construcción y la destrucción
+  class Scope {
+  public:
+    explicit Scope(std::string name) : name(std::move(name)), begin(Clock::now()) {}
+    ~Scope() {
+      record(name, begin, Clock::now());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    std::string name;
+    Clock::time_point begin;
+  };
+
+  // Lista las fases anotadas desde el último reporte
+  static void report(std::ostream& out, const char* title) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Event> pending(events.begin() + static_cast<std::ptrdiff_t>(reported), events.end());
+    reported = events.size();
+    if (pending.empty()) {
+      return;
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const Event& a, const Event& b) { return a.begin < b.begin; });
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << title << " (ms desde el inicio, duración, hilo):" << std::endl;
+    for (const Event& event : pending) {
+      out << "  " << std::fixed << std::setprecision(1) << std::setw(8) << milliseconds(origin, event.begin) << " "
+          << std::setw(8) << milliseconds(event.begin, event.end) << "  [" << event.thread << "] " << event.name << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+private:
+  struct Event {
+    std::string name;
+    Clock::time_point begin;
+    Clock::time_point end;
+    int thread;
+  };
+
+  static double milliseconds(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  }
+
+  static int threadIndex(std::thread::id id) {
+    auto it = std::find(threads.begin(), threads.end(), id);
+    if (it != threads.end()) {
+      return static_cast<int>(it - threads.begin());
+    }
+    threads.push_back(id);
+    return static_cast<int>(threads.size()) - 1;
+  }
+
+  inline static std::mutex mutex;
+  inline static Clock::time_point origin = Clock::now();
+  inline static std::vector<Event> events;
+  inline static std::vector<std::thread::id> threads;
+  inline static size_t reported = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "framebuffer.h"
+#include "radiance.h"
+#include "raypacket.h"
+
+enum class ToneMap {
+  Clamp,    // recorta en 1: igual que la imagen de antes para radiancias <= 1
+  Reinhard, // x / (1 + x)
+  Aces,     // ajuste de Narkowicz de la curva filmica ACES
+};
+
+// Último paso del cuadro: exposición, curva de tonemap y codificación sRGB.
+// La radiancia de cada canal ya mapeada a [0, 1] indexa una tabla con el byte
+// sRGB, así que cada píxel se cuantiza una sola vez. La curva se calcula de a
+// PACKET_SIZE canales sobre la fila de floats, sin separar r, g y b.
+class Tonemapper {
+public:
+  static constexpr int LUT_SIZE = 4096;
+
+  Tonemapper(ToneMap toneMap = ToneMap::Clamp, float exposure = 1.0f)
+    : toneMap(toneMap), exposure(exposure) {
+    for (int i = 0; i < LUT_SIZE; i++) {
+      float srgb = linearToSrgb(static_cast<float>(i) / (LUT_SIZE - 1));
+      encode[i] = static_cast<std::uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+  }
+
+  void setToneMap(ToneMap newToneMap) {
+    toneMap = newToneMap;
+  }
+
+  ToneMap getToneMap() const {
+    return toneMap;
+  }
+
+  void setExposure(float newExposure) {
+    exposure = newExposure;
+  }
+
+  // Convierte el rectángulo [x0, x1) x [y0, y1) de `source` a `target`
+  void resolve(const HdrFramebuffer& source, Framebuffer& target, int x0, int y0, int x1, int y1) const {
+    const int channels = 3 * (x1 - x0);
+    alignas(32) float indices[PACKET_SIZE];
+    alignas(32) float tail[PACKET_SIZE];
+
+    for (int y = y0; y < y1; y++) {
+      const float* radiance = source.row(y) + 3 * x0;
+      std::uint8_t* out = &target.at(x0, y).r;
+
+      for (int i = 0; i < channels; i += PACKET_SIZE) {
+        Lanes values;
+        if (i + PACKET_SIZE <= channels) {
+          values = lanesLoadUnaligned(radiance + i);
+        } else {
+          // El final de la fila no llena los carriles; se rellena con ceros
+          std::fill(tail, tail + PACKET_SIZE, 0.0f);
+          std::copy(radiance + i, radiance + channels, tail);
+          values = lanesLoad(tail);
+        }
+        lanesStore(indices, lanesAdd(lanesMul(curve(values), lanesSet(LUT_SIZE - 1.0f)), lanesSet(0.5f)));
+
+        int count = std::min(PACKET_SIZE, channels - i);
+        for (int lane = 0; lane < count; lane++) {
+          int channel = i + lane;
+          out[(channel / 3) * 4 + channel % 3] = encode[static_cast<int>(indices[lane])];
+        }
+      }
+      for (int x = 0; x < x1 - x0; x++) {
+        out[x * 4 + 3] = 255;
+      }
+    }
+  }
+
+private:
+  // Radiancia con exposición a [0, 1]; los NaN y negativos quedan en 0
+  Lanes curve(Lanes values) const {
+    Lanes zero = lanesSet(0.0f);
+    Lanes one = lanesSet(1.0f);
+    Lanes x = lanesMax(zero, lanesMul(values, lanesSet(exposure)));
+    switch (toneMap) {
+      case ToneMap::Reinhard:
+        return lanesDiv(x, lanesAdd(one, x));
+      case ToneMap::Aces: {
+        Lanes numerator = lanesMul(x, lanesAdd(lanesMul(x, lanesSet(2.51f)), lanesSet(0.03f)));
+        Lanes denominator = lanesAdd(lanesMul(x, lanesAdd(lanesMul(x, lanesSet(2.43f)), lanesSet(0.59f))), lanesSet(0.14f));
+        return lanesMin(lanesDiv(numerator, denominator), one);
+      }
+      default:
+        return lanesMin(x, one);
+    }
+  }
+
+  ToneMap toneMap;
+  float exposure;
+  std::array<std::uint8_t, LUT_SIZE> encode;
+};
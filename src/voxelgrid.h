@@ -0,0 +1,332 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "aabb.h"
+#include "accelerator.h"
+#include "boxsoa.h"
+#include "ray.h"
+#include "raybox.h"
+
+// Grilla uniforme de bloques recorrida con 3D-DDA (Amanatides & Woo).
+// Cada celda guarda el índice del bloque que la ocupa exactamente o, si hay
+// cajas que no son de una celda (como el piso de pasto), una lista de bloques.
+class VoxelGrid : public Accelerator {
+public:
+  const char* name() const override {
+    return "Grilla";
+  }
+
+protected:
+  int findClosest(Ray& ray, int ignore) const override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int hitId = -1;
+    Mailbox mailbox;
+
+    uint64_t visited = walk(ray, [&](int cell, float cellExit) {
+      forEachInCell(cell, mailbox, [&](int id) {
+        float blockDist;
+        if (id != ignore && blocks.intersect(id, ray, blockDist) &&
+            (blockDist < ray.tMax || (blockDist == ray.tMax && id < hitId))) {
+          ray.tMax = blockDist;
+          hitId = id;
+        }
+        return false;
+      });
+      // Un impacto dentro de la celda actual no puede ser superado por celdas
+      // posteriores, y las que empiezan después de tMax ya no cuentan
+      return ray.tMax < cellExit;
+    });
+
+    countRay(visited);
+    return hitId;
+  }
+
+  void buildStructure(ThreadPool&) override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int blockCount = blocks.size();
+    cells.clear();
+    lists.clear();
+    listItems.clear();
+    dims = glm::ivec3(0, 0, 0);
+
+    AABB sceneBounds;
+    for (int id = 0; id < blockCount; id++) {
+      sceneBounds.expand(blocks.box(id));
+    }
+    if (blockCount == 0) {
+      stats.nodeCount = 0;
+      return;
+    }
+
+    // Celdas de un bloque; se agrandan si la escena no cabe en MAX_CELLS
+    origin = sceneBounds.min;
+    glm::vec3 extent = sceneBounds.max - sceneBounds.min;
+    cellSize = 1.0f;
+    while (true) {
+      for (int axis = 0; axis < 3; axis++) {
+        dims[axis] = std::max(1, static_cast<int>(std::ceil(extent[axis] / cellSize)));
+      }
+      if (static_cast<int64_t>(dims.x) * dims.y * dims.z <= MAX_CELLS) {
+        break;
+      }
+      cellSize *= 2.0f;
+    }
+    cells.assign(static_cast<size_t>(dims.x) * dims.y * dims.z, EMPTY);
+
+    // Los bloques que ocupan exactamente una celda van directo a la grilla;
+    // el resto se reparte en listas por celda
+    std::vector<std::pair<int, int>> overlaps;
+    for (int id = 0; id < blockCount; id++) {
+      AABB b = blocks.box(id);
+      glm::ivec3 lo, hi;
+      for (int axis = 0; axis < 3; axis++) {
+        lo[axis] = std::clamp(static_cast<int>(std::floor((b.min[axis] - origin[axis]) / cellSize + EPSILON)), 0, dims[axis] - 1);
+        hi[axis] = std::clamp(static_cast<int>(std::ceil((b.max[axis] - origin[axis]) / cellSize - EPSILON)) - 1, lo[axis], dims[axis] - 1);
+      }
+
+      if (lo.x == hi.x && lo.y == hi.y && lo.z == hi.z && isCell(b, lo)) {
+        int& cell = cells[cellIndex(lo.x, lo.y, lo.z)];
+        if (cell == EMPTY) {
+          cell = id;
+          continue;
+        }
+      }
+      for (int z = lo.z; z <= hi.z; z++) {
+        for (int y = lo.y; y <= hi.y; y++) {
+          for (int x = lo.x; x <= hi.x; x++) {
+            overlaps.push_back({cellIndex(x, y, z), id});
+          }
+        }
+      }
+    }
+
+    std::sort(overlaps.begin(), overlaps.end());
+    for (size_t i = 0; i < overlaps.size();) {
+      int index = overlaps[i].first;
+      CellList list{static_cast<int>(listItems.size()), 0};
+      if (cells[index] != EMPTY) {
+        listItems.push_back(cells[index]);
+      }
+      for (; i < overlaps.size() && overlaps[i].first == index; i++) {
+        listItems.push_back(overlaps[i].second);
+      }
+      list.count = static_cast<int>(listItems.size()) - list.start;
+      cells[index] = -static_cast<int>(lists.size()) - 2;
+      lists.push_back(list);
+    }
+
+    stats.nodeCount = static_cast<int>(cells.size());
+  }
+
+  int findOccluder(Ray& ray, int ignore) const override {
+    const BoxSoA& blocks = scene->blockBoxes();
+    int occluder = -1;
+    Mailbox mailbox;
+
+    uint64_t visited = walk(ray, [&](int cell, float cellExit) {
+      forEachInCell(cell, mailbox, [&](int id) {
+        float blockDist;
+        if (id != ignore && blocks.intersect(id, ray, blockDist) && blockDist > ray.tMin && blockDist < ray.tMax) {
+          ray.tMax = blockDist;
+          occluder = id;
+        }
+        return false;
+      });
+      // Igual que en findClosest: pasada la celda del oclusor (o la luz) no
+      // queda ninguno más cercano
+      return ray.tMax < cellExit;
+    });
+
+    countRay(visited);
+    return occluder;
+  }
+
+  size_t memoryBytes() const override {
+    return cells.capacity() * sizeof(int) + lists.capacity() * sizeof(CellList) + listItems.capacity() * sizeof(int);
+  }
+
+private:
+  static constexpr int EMPTY = -1;
+  static constexpr int64_t MAX_CELLS = 1 << 24;
+  static constexpr float EPSILON = 0.0001f;
+
+  struct CellList {
+    int start;
+    int count;
+  };
+
+  // Últimos objetos de lista probados: una caja grande cruza muchas celdas
+  struct Mailbox {
+    int ids[4] = {-1, -1, -1, -1};
+    int next = 0;
+
+    bool testedBefore(int id) {
+      for (int tested : ids) {
+        if (tested == id) {
+          return true;
+        }
+      }
+      ids[next] = id;
+      next = (next + 1) % 4;
+      return false;
+    }
+  };
+
+  int cellIndex(int x, int y, int z) const {
+    return (z * dims.y + y) * dims.x + x;
+  }
+
+  bool isCell(const AABB& b, const glm::ivec3& cell) const {
+    for (int axis = 0; axis < 3; axis++) {
+      float cellMin = origin[axis] + cell[axis] * cellSize;
+      if (std::abs(b.min[axis] - cellMin) > EPSILON || std::abs(b.max[axis] - (cellMin + cellSize)) > EPSILON) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Llama visit(id) para cada objeto de la celda; se detiene si devuelve true
+  template <typename Visit>
+  bool forEachInCell(int cell, Mailbox& mailbox, Visit visit) const {
+    int value = cells[cell];
+    if (value == EMPTY) {
+      return false;
+    }
+    if (value >= 0) {
+      return visit(value);
+    }
+    const CellList& list = lists[-value - 2];
+    for (int i = list.start; i < list.start + list.count; i++) {
+      int id = listItems[i];
+      if (!mailbox.testedBefore(id) && visit(id)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Recorre las celdas que cruza el rayo de adelante hacia atrás, desde tMin.
+  // visitCell(celda, tSalida) devuelve true para terminar. Devuelve las celdas visitadas.
+  template <typename VisitCell>
+  uint64_t walk(const Ray& ray, VisitCell visitCell) const {
+    if (cells.empty()) {
+      return 0;
+    }
+
+    AABB gridBounds{origin, origin + glm::vec3(dims.x, dims.y, dims.z) * cellSize};
+    float tEnter;
+    if (!gridBounds.intersect(ray, tEnter) || tEnter > ray.tMax) {
+      return 0;
+    }
+    tEnter = std::max(tEnter, ray.tMin);
+
+    // La celda de entrada se calcula en double: en float, un punto apenas
+    // adentro de una celda puede redondear al borde de la siguiente. tNext es la
+    // distancia al próximo borde de celda en cada eje; sale del plano del
+    // borde, igual que el slab test de las cajas, en vez de ir sumando un paso
+    // que acumula redondeo.
+    glm::vec3 entry = ray.at(tEnter);
+    glm::ivec3 cell, step;
+    glm::vec3 tNext;
+    for (int axis = 0; axis < 3; axis++) {
+      double offset = (static_cast<double>(entry[axis]) - origin[axis]) / cellSize;
+      cell[axis] = std::clamp(static_cast<int>(std::floor(offset)), 0, dims[axis] - 1);
+      step[axis] = (ray.direction[axis] > 0) ? 1 : ((ray.direction[axis] < 0) ? -1 : 0);
+      tNext[axis] = boundaryDistance(ray, cell, step, axis);
+    }
+
+    // La misma holgura hacia atrás: si la entrada cae sobre un borde de celda,
+    // la celda de detrás también toca el rayo en tEnter. Se arranca desde ella
+    // y el paso hacia adelante, con las vecinas de abajo, cubre el resto.
+    glm::ivec3 back(-step.x, -step.y, -step.z);
+    for (int axis = 0; axis < 3; axis++) {
+      int behind = cell[axis] - step[axis];
+      if (step[axis] != 0 && behind >= 0 && behind < dims[axis] &&
+          boundaryDistance(ray, cell, back, axis) * SLAB_TOLERANCE >= tEnter) {
+        cell[axis] = behind;
+        tNext[axis] = boundaryDistance(ray, cell, step, axis);
+      }
+    }
+
+    uint64_t visited = 0;
+    while (true) {
+      visited++;
+      int axis = (tNext.x < tNext.y) ? ((tNext.x < tNext.z) ? 0 : 2) : ((tNext.y < tNext.z) ? 1 : 2);
+      if (visitCell(cellIndex(cell.x, cell.y, cell.z), tNext[axis])) {
+        break;
+      }
+
+      // Si otros bordes están a menos de la holgura del slab test, el rayo pasa
+      // por una arista o una esquina y las cajas de las celdas vecinas también
+      // lo aceptan: se visitan las que el paso por `axis` saltearía, corriendo
+      // la celda en cada combinación de esos ejes (en una esquina, también la
+      // diagonal que cruza los dos)
+      int nearAxes = 0;
+      for (int other = 0; other < 3; other++) {
+        if (other != axis && step[other] != 0 && tNext[other] <= tNext[axis] * SLAB_TOLERANCE) {
+          nearAxes |= 1 << other;
+        }
+      }
+      if (nearAxes && visitNeighbours(cell, step, nearAxes, tNext[axis], visited, visitCell)) {
+        break;
+      }
+
+      cell[axis] += step[axis];
+      if (cell[axis] < 0 || cell[axis] >= dims[axis]) {
+        break;
+      }
+      tNext[axis] = boundaryDistance(ray, cell, step, axis);
+    }
+    return visited;
+  }
+
+  // Visita las vecinas de `cell` corridas un paso de `step` en cada
+  // combinación no vacía de los ejes de `axes`, las que caen dentro de la
+  // grilla; devuelve true si visitCell pidió terminar
+  template <typename VisitCell>
+  bool visitNeighbours(const glm::ivec3& cell, const glm::ivec3& step, int axes, float cellExit, uint64_t& visited,
+                       VisitCell& visitCell) const {
+    for (int combination = 1; combination < 8; combination++) {
+      if ((combination & axes) != combination) {
+        continue;
+      }
+      glm::ivec3 neighbour = cell;
+      bool inside = true;
+      for (int axis = 0; axis < 3; axis++) {
+        if (combination & (1 << axis)) {
+          neighbour[axis] += step[axis];
+          inside = inside && neighbour[axis] >= 0 && neighbour[axis] < dims[axis];
+        }
+      }
+      if (inside) {
+        visited++;
+        if (visitCell(cellIndex(neighbour.x, neighbour.y, neighbour.z), cellExit)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Distancia al borde de `cell` por el que sale el rayo en `axis` yendo hacia `step`
+  float boundaryDistance(const Ray& ray, const glm::ivec3& cell, const glm::ivec3& step, int axis) const {
+    if (step[axis] == 0) {
+      return std::numeric_limits<float>::infinity();
+    }
+    float plane = origin[axis] + (cell[axis] + (step[axis] > 0 ? 1 : 0)) * cellSize;
+    return (plane - ray.origin[axis]) * ray.invDir[axis];
+  }
+
+  std::vector<int> cells;
+  std::vector<CellList> lists;
+  std::vector<int> listItems;
+  glm::vec3 origin;
+  glm::ivec3 dims;
+  float cellSize = 1.0f;
+};
@@ -0,0 +1,138 @@
+// Fuerza bruta, BVH y grilla sobre una grilla de bloques unitarios con rayos
+// apuntados a las esquinas y aristas de la red: el impacto más cercano (id y
+// distancia) y el oclusor más cercano tienen que coincidir aunque el rayo
+// solo roce una caja por una esquina. Los paquetes se trazan con el tramo
+// [tMin, tMax] de cada carril y tienen que dar lo mismo que un rayo suelto.
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "accelerator.h"
+#include "block.h"
+#include "bvh.h"
+#include "ray.h"
+#include "raypacket.h"
+#include "scene.h"
+#include "threadpool.h"
+#include "voxelgrid.h"
+
+namespace {
+
+constexpr int LATTICE = 8;
+
+// Un cuarto de las celdas de la red ocupadas por un bloque unitario
+void fillLattice(Scene& scene, unsigned seed) {
+    scene.addBlockType(BlockType{"bloque", FaceTextures{}, Material{}});
+    std::mt19937 rng(seed);
+    for (int x = 0; x < LATTICE; x++) {
+        for (int y = 0; y < LATTICE; y++) {
+            for (int z = 0; z < LATTICE; z++) {
+                if (rng() % 4 == 0) {
+                    scene.addBlock(glm::vec3(x, y, z), glm::vec3(x + 1, y + 1, z + 1), 0);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    int closestMismatches = 0;
+    int occluderMismatches = 0;
+    int packetMismatches = 0;
+    int rays = 0;
+    for (unsigned seed = 0; seed < 8; seed++) {
+        Scene scene;
+        fillLattice(scene, seed);
+        ThreadPool pool(1);
+        BruteForce brute;
+        BVH bvh;
+        VoxelGrid grid;
+        Accelerator* accelerators[] = {&brute, &bvh, &grid};
+        for (Accelerator* accelerator : accelerators) {
+            accelerator->build(scene, pool);
+        }
+
+        std::mt19937 rng(100 + seed);
+        std::uniform_int_distribution<int> corner(0, LATTICE);
+        std::uniform_int_distribution<int> offset(-4, 4);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<Ray> segments;
+        auto tracePacket = [&]() {
+            RayPacket packet;
+            packet.count = static_cast<int>(segments.size());
+            for (int lane = 0; lane < PACKET_SIZE; lane++) {
+                packet.set(lane, segments[std::min(lane, packet.count - 1)]);
+            }
+            for (Accelerator* accelerator : {static_cast<Accelerator*>(&brute), static_cast<Accelerator*>(&bvh)}) {
+                PacketHit hits;
+                accelerator->closestHitPacket(packet, hits);
+                for (int lane = 0; lane < packet.count; lane++) {
+                    Hit expected = brute.closestHit(segments[lane], -1);
+                    if (hits.ids[lane] != expected.primitive ||
+                        (expected.primitive >= 0 && hits.dist[lane] != expected.dist)) {
+                        packetMismatches++;
+                    }
+                }
+            }
+            segments.clear();
+        };
+        for (int i = 0; i < 10000; i++) {
+            // Hacia una esquina de la red (o el medio de una arista), desde un
+            // punto cualquiera o desde otro punto de la red
+            glm::vec3 target(corner(rng), corner(rng), corner(rng));
+            if (i % 3 == 0) {
+                target[i % 2] += 0.5f;
+            }
+            glm::vec3 origin = (i % 2) ? target + glm::vec3(offset(rng), offset(rng), offset(rng)) * 3.0f
+                                       : target + glm::vec3(unit(rng), unit(rng), unit(rng)) * 20.0f;
+            if (origin == target) {
+                continue;
+            }
+            Ray ray(origin, glm::normalize(target - origin));
+            Hit reference = brute.closestHit(ray, -1);
+            // Un origen dentro de un bloque da distancia 0, que el renderer no produce
+            if (reference.primitive >= 0 && reference.dist <= 0.0f) {
+                continue;
+            }
+            rays++;
+
+            Ray shadow(origin, ray.direction, 0.0f, glm::length(target - origin) + 2.0f);
+            float referenceDist = -1.0f;
+            bool referenceOccluded = brute.occluded(shadow, -1, referenceDist);
+            for (Accelerator* accelerator : {static_cast<Accelerator*>(&bvh), static_cast<Accelerator*>(&grid)}) {
+                Hit hit = accelerator->closestHit(ray, -1);
+                if (hit.primitive != reference.primitive || (hit.primitive >= 0 && hit.dist != reference.dist)) {
+                    closestMismatches++;
+                }
+                float dist = -1.0f;
+                bool occluded = accelerator->occluded(shadow, -1, dist);
+                if (occluded != referenceOccluded || (occluded && dist != referenceDist)) {
+                    occluderMismatches++;
+                }
+            }
+
+            // El mismo rayo recortado a un tramo que empieza o termina dentro de la red
+            segments.push_back(Ray(origin, ray.direction, (i % 4) * 2.0f, glm::length(target - origin) + (i % 5) - 2.0f));
+            if (segments.size() == PACKET_SIZE) {
+                tracePacket();
+            }
+        }
+        if (!segments.empty()) {
+            tracePacket();
+        }
+    }
+
+    bool ok = closestMismatches == 0 && occluderMismatches == 0 && packetMismatches == 0;
+    if (!ok) {
+        std::cerr << "Falla: de " << rays << " rayos, " << closestMismatches << " impactos, " << occluderMismatches
+                  << " oclusores y " << packetMismatches << " carriles de paquete distintos de la fuerza bruta"
+                  << std::endl;
+    } else {
+        std::cout << "Aceleradores: " << rays << " rayos por esquinas y aristas, todo igual" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Cada imagen depende solo de la escena y la cámara: con fuerza bruta, BVH y
+// grilla, con paquetes o sin ellos y con cualquier cantidad de hilos tiene que
+// salir byte a byte igual, también el segundo cuadro del mismo Renderer (con
+// los cachés por hilo ya llenos). Usa texturas generadas, así no lee archivos.
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "camera.h"
+#include "diorama.h"
+#include "framebuffer.h"
+#include "imageloader.h"
+#include "renderer.h"
+#include "skybox.h"
+
+namespace {
+
+constexpr int IMAGE_WIDTH = 240;
+constexpr int IMAGE_HEIGHT = 180;
+
+// Tablero con un degradé, distinto para cada textura
+Texture pattern(int seed, const TextureEntry& entry) {
+    Texture texture;
+    texture.width = 32;
+    texture.height = 32;
+    texture.size = glm::vec2(entry.width, entry.height);
+    for (int y = 0; y < texture.height; y++) {
+        for (int x = 0; x < texture.width; x++) {
+            int check = ((x / 4 + y / 4 + seed) % 2) * 60;
+            texture.texels.push_back(Color(40 + check + 5 * x, 60 + 17 * seed % 120, 200 - 5 * y - check));
+        }
+    }
+    return texture;
+}
+
+struct Setup {
+    const char* name;
+    const char* accelerator;
+    unsigned threads;
+    bool packets;
+};
+
+// Dos cuadros seguidos con la misma cámara y el mismo Renderer
+std::vector<std::vector<Color>> render(const std::string& sceneName, const Setup& setup) {
+    Renderer renderer(IMAGE_WIDTH, IMAGE_HEIGHT);
+    renderer.progressive.setEnabled(false);
+    renderer.reprojection.setEnabled(false);
+    renderer.setUsePackets(setup.packets);
+    Camera camera(glm::vec3(-3.0f, 2.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
+    if (sceneName == "diorama") {
+        setUp(renderer.scene);
+    } else {
+        generateTerrain(renderer.scene, 24, 7u);
+        camera = Camera(glm::vec3(30.0f, 14.0f, 30.0f), glm::vec3(12.0f, 0.0f, 12.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
+    }
+    renderer.start(setup.threads);
+    renderer.setAccelerator(setup.accelerator);
+    std::vector<std::vector<Color>> frames;
+    for (int frame = 0; frame < 2; frame++) {
+        Framebuffer image(IMAGE_WIDTH, IMAGE_HEIGHT);
+        renderer.beginFrame(camera, image);
+        renderer.endFrame();
+        frames.push_back(image.pixels);
+    }
+    return frames;
+}
+
+int differingPixels(const std::vector<Color>& a, const std::vector<Color>& b) {
+    int count = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        count += std::memcmp(&a[i], &b[i], sizeof(Color)) != 0;
+    }
+    return count;
+}
+
+} // namespace
+
+int main() {
+    int seed = 0;
+    for (const TextureEntry& entry : DIORAMA_TEXTURES) {
+        ImageLoader::addTexture(entry.key, pattern(seed++, entry));
+    }
+    Skybox::loadTextures();
+    ImageLoader::freeze();
+
+    const Setup setups[] = {
+        {"fuerza bruta, 1 hilo", "brute", 1, true},
+        {"fuerza bruta, 8 hilos", "brute", 8, true},
+        {"BVH, 1 hilo", "bvh", 1, true},
+        {"BVH, 8 hilos", "bvh", 8, true},
+        {"BVH sin paquetes, 3 hilos", "bvh", 3, false},
+        {"grilla, 1 hilo", "grid", 1, true},
+        {"grilla, 8 hilos", "grid", 8, true},
+    };
+
+    int failures = 0;
+    for (const char* sceneName : {"diorama", "terrain"}) {
+        std::vector<Color> reference = render(sceneName, setups[0]).front();
+        for (const Setup& setup : setups) {
+            // El segundo cuadro ya encuentra los cachés por hilo del primero
+            std::vector<std::vector<Color>> frames = render(sceneName, setup);
+            for (size_t frame = 0; frame < frames.size(); frame++) {
+                int differing = differingPixels(reference, frames[frame]);
+                if (differing > 0) {
+                    std::cerr << sceneName << ", " << setup.name << ", cuadro " << frame + 1 << ": " << differing
+                              << " píxeles distintos de " << setups[0].name << std::endl;
+                    failures++;
+                }
+            }
+        }
+    }
+    if (failures == 0) {
+        std::cout << "Todas las imágenes coinciden" << std::endl;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+// Casos borde del núcleo rayo/caja (rayBox, AABB::intersect y las tandas de
+// BoxSoA): rayos paralelos a los ejes, componentes ±0, aristas y esquinas
+// compartidas, rayos que empiezan adentro y la cara elegida.
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include "aabb.h"
+#include "boxsoa.h"
+#include "ray.h"
+#include "raybox.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "Falla: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Impacto de la tanda de BoxSoA contra una sola caja
+bool batchHit(const glm::vec3& minBound, const glm::vec3& maxBound, const Ray& ray, float& dist) {
+    BoxSoA boxes;
+    boxes.push(AABB{minBound, maxBound}, 0);
+    Ray clipped = ray;
+    int index = -1;
+    boxes.closest(clipped, 0, boxes.size(), -1, index);
+    dist = clipped.tMax;
+    return index == 0;
+}
+
+const glm::vec3 UNIT_MIN(0.0f);
+const glm::vec3 UNIT_MAX(1.0f);
+
+void axisParallel() {
+    const struct {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        int face;
+    } cases[] = {
+        {{-2.0f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}, FACE_MIN_X},
+        {{3.0f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f}, FACE_MAX_X},
+        {{0.5f, -2.0f, 0.5f}, {0.0f, 1.0f, 0.0f}, FACE_MIN_Y},
+        {{0.5f, 3.0f, 0.5f}, {0.0f, -1.0f, 0.0f}, FACE_MAX_Y},
+        {{0.5f, 0.5f, -2.0f}, {0.0f, 0.0f, 1.0f}, FACE_MIN_Z},
+        {{0.5f, 0.5f, 3.0f}, {0.0f, 0.0f, -1.0f}, FACE_MAX_Z},
+    };
+    for (const auto& c : cases) {
+        BoxHit hit;
+        std::string name = "paralelo al eje, cara " + std::to_string(c.face);
+        check(rayBox(UNIT_MIN, UNIT_MAX, Ray(c.origin, c.direction), hit), name + ": impacto");
+        check(hit.dist == 2.0f, name + ": distancia 2");
+        check(hit.face == c.face, name + ": cara");
+        check(hit.uv.x == 0.5f && hit.uv.y == 0.5f, name + ": uv en el centro de la cara");
+        // Corrido fuera de la caja en un eje perpendicular ya no la toca
+        glm::vec3 offset(0.0f);
+        offset[(c.face / 2 + 1) % 3] = 2.0f;
+        check(!rayBox(UNIT_MIN, UNIT_MAX, Ray(c.origin + offset, c.direction), hit), name + ": corrido no impacta");
+    }
+}
+
+void zeroComponents() {
+    for (float zero : {0.0f, -0.0f}) {
+        std::string sign = std::signbit(zero) ? "-0" : "+0";
+        Ray ray(glm::vec3(-1.0f, 0.5f, 0.5f), glm::vec3(1.0f, zero, zero));
+        check(std::isfinite(ray.invDir.y) && std::isfinite(ray.invDir.z), sign + ": inverso finito");
+        check(ray.sign[1] == (std::signbit(zero) ? 1 : 0), sign + ": el signo sigue al cero");
+
+        BoxHit hit;
+        check(rayBox(UNIT_MIN, UNIT_MAX, ray, hit) && hit.dist == 1.0f && hit.face == FACE_MIN_X, sign + ": impacto dentro del slab");
+        check(!std::isnan(hit.uv.x) && !std::isnan(hit.uv.y), sign + ": uv sin NaN");
+        check(!rayBox(UNIT_MIN, UNIT_MAX, Ray(glm::vec3(-1.0f, 1.5f, 0.5f), glm::vec3(1.0f, zero, 0.0f)), hit),
+              sign + ": fuera del slab no impacta");
+
+        // Sobre el plano que comparten dos cajas vecinas, el rayo cuenta en una sola
+        glm::vec3 origin(-1.0f, 1.0f, 0.5f);
+        Ray onPlane(origin, glm::vec3(1.0f, zero, 0.0f));
+        bool below = rayBox(glm::vec3(0.0f), glm::vec3(1.0f), onPlane, hit);
+        bool above = rayBox(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 2.0f, 1.0f), onPlane, hit);
+        check(below != above, sign + ": en el plano compartido impacta exactamente una caja");
+    }
+}
+
+// Rayos apuntados a la arista que comparten cuatro cajas y a la esquina que
+// comparten ocho: alguna tiene que aceptarlos
+void edgesAndCorners() {
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    glm::vec3 mins[8], maxs[8];
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        mins[i] = corner - glm::vec3(1.0f);
+        maxs[i] = corner;
+    }
+
+    int gaps = 0;
+    for (int i = 0; i < 100000; i++) {
+        glm::vec3 origin(unit(rng) * 9.0f, unit(rng) * 9.0f, 4.0f + unit(rng) * 4.0f);
+        origin = glm::normalize(origin) * (3.0f + 6.0f * std::abs(unit(rng)));
+        // La mitad a la esquina (0, 0, 0), la otra mitad a la arista x = y = 0
+        glm::vec3 target(0.0f, 0.0f, (i % 2) ? 0.0f : unit(rng) * 0.9f);
+        Ray ray(origin, glm::normalize(target - origin));
+        bool hitAny = false;
+        for (int box = 0; box < 8 && !hitAny; box++) {
+            BoxHit hit;
+            hitAny = rayBox(mins[box], maxs[box], ray, hit);
+        }
+        gaps += !hitAny;
+    }
+    check(gaps == 0, std::to_string(gaps) + " rayos pasaron entre cajas por una arista o esquina");
+
+    // La caja es cerrada: un rayo que solo roza la arista (tNear == tFar) la toca
+    BoxHit hit;
+    Ray grazing(glm::vec3(-1.0f, 0.0f, 0.5f), glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)));
+    check(rayBox(UNIT_MIN, UNIT_MAX, grazing, hit) && (hit.face == FACE_MIN_X || hit.face == FACE_MAX_Y),
+          "rozando la arista: impacto en una de sus dos caras");
+}
+
+void startingInside() {
+    Ray ray(glm::vec3(0.25f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f));
+    BoxHit hit;
+    check(rayBox(UNIT_MIN, UNIT_MAX, ray, hit), "desde adentro: impacto");
+    check(hit.dist == 0.75f, "desde adentro: devuelve tFar");
+    check(hit.face == FACE_MAX_X, "desde adentro: la cara por la que sale");
+    float tNear, tFar, dist;
+    check(AABB{UNIT_MIN, UNIT_MAX}.intersect(ray, tNear, tFar) && tNear < 0.0f && clipToRay(ray, tNear, tFar, dist) && dist == 0.75f,
+          "desde adentro: AABB::intersect y clipToRay dan tFar");
+    check(batchHit(UNIT_MIN, UNIT_MAX, ray, dist) && dist == 0.75f, "desde adentro: la tanda da tFar");
+
+    Ray limited(ray.origin, ray.direction, 0.0f, 0.5f);
+    check(!rayBox(UNIT_MIN, UNIT_MAX, limited, hit), "desde adentro: la salida más allá de tMax no cuenta");
+}
+
+// Cajas y rayos al azar: rayBox, AABB::intersect y la tanda de BoxSoA aceptan
+// los mismos impactos a la misma distancia, y la cara es la del plano que la dio
+void matchesBatch() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    int mismatches = 0;
+    int wrongFaces = 0;
+    int hits = 0;
+    for (int i = 0; i < 200000; i++) {
+        glm::vec3 minBound(std::round(unit(rng) * 4.0f), std::round(unit(rng) * 4.0f), std::round(unit(rng) * 4.0f));
+        glm::vec3 maxBound = minBound + glm::vec3(1.0f + (i % 3), 1.0f, 1.0f + (i % 2));
+        glm::vec3 origin = glm::vec3(unit(rng), unit(rng), unit(rng)) * 8.0f;
+        // La mitad apunta a un punto de la caja, el resto a cualquier lado
+        glm::vec3 direction(unit(rng), unit(rng), unit(rng));
+        if (i % 2 == 0) {
+            glm::vec3 fraction(unit(rng), unit(rng), unit(rng));
+            direction = minBound + (fraction * 0.5f + 0.5f) * (maxBound - minBound) - origin;
+        }
+        if (i % 4 == 0) {
+            direction[i % 3] = (i % 8 == 0) ? 0.0f : -0.0f;
+        }
+        if (glm::length(direction) == 0.0f) {
+            continue;
+        }
+        Ray ray(origin, glm::normalize(direction));
+
+        BoxHit hit;
+        bool kernel = rayBox(minBound, maxBound, ray, hit);
+        float batchDist;
+        bool batch = batchHit(minBound, maxBound, ray, batchDist);
+        float tNear, tFar, slabDist;
+        bool slab = AABB{minBound, maxBound}.intersect(ray, tNear, tFar) && clipToRay(ray, tNear, tFar, slabDist);
+        if (kernel != batch || kernel != slab || (kernel && (!sameBits(hit.dist, batchDist) || !sameBits(hit.dist, slabDist)))) {
+            mismatches++;
+            continue;
+        }
+        if (!kernel) {
+            continue;
+        }
+        hits++;
+        int axis = hit.face / 2;
+        bool inside = tNear < ray.tMin;
+        bool maxSide = (ray.sign[axis] == 1) != inside;
+        float plane = maxSide ? maxBound[axis] : minBound[axis];
+        wrongFaces += !sameBits((plane - ray.origin[axis]) * ray.invDir[axis], hit.dist);
+    }
+    check(hits > 10000, "al azar: pocos impactos para comparar");
+    check(mismatches == 0, std::to_string(mismatches) + " rayos con distinto resultado entre rayBox, AABB y la tanda");
+    check(wrongFaces == 0, std::to_string(wrongFaces) + " caras que no son el plano de la distancia");
+}
+
+} // namespace
+
+int main() {
+    axisParallel();
+    zeroComponents();
+    edgesAndCorners();
+    startingInside();
+    matchesBatch();
+    if (failures == 0) {
+        std::cout << "Núcleo rayo/caja: todo bien" << std::endl;
+    }
+    return failures > 0 ? 1 : 0;
+}